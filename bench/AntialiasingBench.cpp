@@ -0,0 +1,193 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.hpp"
+#include "Pixel/Application.hpp"
+#include "Pixel/PostProcess.hpp"
+#include "Pixel/RenderTarget.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Util/Logger.hpp"
+
+using namespace Pixel;
+
+// Renders the same edge-heavy scene into offscreen targets at 1080p and 4K with every antialiasing mode and
+// reports GPU frame time and color memory as JSON on stdout.
+
+struct BenchResult {
+  const char* mode;
+  glm::uvec2  resolution;
+  double      gpu_ms;
+  uint64_t    color_bytes;
+};
+
+static constexpr uint32_t warmup_frames = 10;
+static constexpr uint32_t frame_count   = 100;
+
+static const char* ModeName(Antialiasing antialiasing) {
+  switch (antialiasing) {
+    case Antialiasing::none:
+      return "none";
+
+    case Antialiasing::msaa_2x:
+      return "msaa_2x";
+
+    case Antialiasing::msaa_4x:
+      return "msaa_4x";
+
+    case Antialiasing::msaa_8x:
+      return "msaa_8x";
+
+    case Antialiasing::fxaa:
+      return "fxaa";
+  }
+
+  return "unknown";
+}
+
+static void DrawScene(float time) {
+  Renderer::BeginBatch();
+
+  for (uint32_t i = 0; i < 2000; i++) {
+    const float     angle = time + i * .37f;
+    const glm::vec2 center {std::cos(i * 1.7f) * 1.6f, std::sin(i * 2.3f) * .9f};
+    const glm::vec2 offset {std::cos(angle) * .05f, std::sin(angle) * .05f};
+    const glm::vec4 color {(i % 7) / 7.f, (i % 5) / 5.f, (i % 3) / 3.f, 1.f};
+
+    Renderer::DrawTri(center + offset, center - offset, center + glm::vec2(-offset.y, offset.x), color);
+    Renderer::DrawLine(center, center + offset * 4.f, color);
+  }
+
+  for (uint32_t i = 0; i < 200; i++) {
+    Renderer::BorderCircle({std::cos(i * .9f) * 1.5f, std::sin(i * 1.1f) * .8f},
+                           .04f,
+                           24,
+                           .005f,
+                           {.2f, .4f, .8f, 1.f});
+  }
+
+  Renderer::EndBatch();
+  Renderer::FlushBatch();
+}
+
+static BenchResult RunBench(Antialiasing antialiasing, const glm::uvec2& resolution, FullscreenPass& fxaa_pass) {
+  const uint32_t samples = AntialiasingSamples(antialiasing);
+  const bool     fxaa    = antialiasing == Antialiasing::fxaa;
+
+  RenderTarget scene, output;
+  scene.Create(resolution, GL_RGBA8, samples);
+  if (fxaa) output.Create(resolution);
+
+  GLuint query;
+  glGenQueries(1, &query);
+
+  double total_ms = 0.;
+
+  for (uint32_t frame = 0; frame < warmup_frames + frame_count; frame++) {
+    glBeginQuery(GL_TIME_ELAPSED, query);
+
+    Renderer::BeginTarget(scene, true, {.05f, .05f, .05f, 1.f});
+    DrawScene(frame * (1.f / 60.f));
+    Renderer::EndTarget();
+
+    if (fxaa) {
+      glBindFramebuffer(GL_FRAMEBUFFER, output.getFramebuffer());
+      glViewport(0, 0, resolution.x, resolution.y);
+      fxaa_pass.Draw(scene, resolution);
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    // Reading back synchronously stalls the pipeline, which is fine here since only GPU time is measured
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    if (frame >= warmup_frames) total_ms += elapsed / 1e6;
+  }
+
+  glDeleteQueries(1, &query);
+
+  // Multisampled storage plus its single-sample resolve texture, and the FXAA output when present
+  const uint64_t pixel_bytes = (uint64_t)resolution.x * resolution.y * 4;
+  const uint64_t color_bytes = pixel_bytes * (samples ? samples + 1 : 1) + (fxaa ? pixel_bytes : 0);
+
+  scene.Release();
+  output.Release();
+
+  return {ModeName(antialiasing), resolution, total_ms / frame_count, color_bytes};
+}
+
+int main() {
+  if (!glfwInit()) Logger::Die("Failed to initialize GLFW");
+
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow* window = glfwCreateWindow(64, 64, "pixel_aa_bench", nullptr, nullptr);
+  if (!window) Logger::Die("Failed to create GLFW window");
+
+  glfwMakeContextCurrent(window);
+  glfwSwapInterval(0);
+
+  glewExperimental = GL_TRUE;
+  if (!!glewInit()) Logger::Die("GLEW initialization failed");
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glEnable(GL_MULTISAMPLE);
+
+  Renderer::Init();
+  Renderer::UseCamera(OrthographicCamera(1.f, 16.f / 9.f));
+
+  FullscreenPass fxaa_pass;
+  fxaa_pass.Create(fxaa_fragment_shader_code);
+
+  const glm::uvec2   resolutions[] = {{1920, 1080}, {3840, 2160}};
+  const Antialiasing modes[]       = {Antialiasing::none,
+                                      Antialiasing::msaa_2x,
+                                      Antialiasing::msaa_4x,
+                                      Antialiasing::msaa_8x,
+                                      Antialiasing::fxaa};
+
+  std::vector<BenchResult> results;
+
+  for (const auto& resolution : resolutions) {
+    for (auto mode : modes) {
+      results.push_back(RunBench(mode, resolution, fxaa_pass));
+    }
+  }
+
+  std::cout << "[\n";
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto& result = results[i];
+
+    std::cout << "  {\"mode\": \"" << result.mode << "\", \"width\": " << result.resolution.x
+              << ", \"height\": " << result.resolution.y << ", \"gpu_ms\": " << result.gpu_ms
+              << ", \"color_bytes\": " << result.color_bytes << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+
+  std::cout << "]\n";
+
+  fxaa_pass.Release();
+  Renderer::Delete();
+
+  glfwDestroyWindow(window);
+  glfwTerminate();
+}
@@ -0,0 +1,320 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.hpp"
+#include "Pixel/NullBackend.hpp"
+#include "Pixel/OrthographicCamera.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Pixel/SoftwareBackend.hpp"
+#include "Util/Logger.hpp"
+
+using namespace Pixel;
+
+// Measures the CPU cost of every Renderer drawing function across segment counts and batch sizes on a headless
+// context, and reports primitives per second and the vertex and index bytes each primitive writes as JSON. The null
+// context skips OpenGL entirely and times only the CPU side of the renderer, with a checksum of everything submitted.
+// The software context rasterizes into a 1280x720 CPU framebuffer with the given number of threads.
+//
+//   pixel_bench [--context egl|osmesa|null|software] [--threads 0] [--min-time-ms 200] [--label text]
+//               [--output results.json]
+
+struct PrimitiveCase {
+  const char* name;
+  bool        segmented;
+  void (*draw)(uint32_t index, uint32_t segments);
+};
+
+struct BenchResult {
+  const char* primitive;
+  uint32_t    segments;
+  uint32_t    batch;
+  uint64_t    iterations;
+  double      draw_ns;    // Per primitive, includes any flush a full batch forces
+  double      submit_ns;  // Per primitive, the EndBatch and FlushBatch at the end of each batch
+  double      finish_ns;  // Per primitive, waiting for the output: glFinish, or shading the tiles in software
+  double      vertex_bytes;
+  double      index_bytes;
+  double      draw_calls;  // Per batch
+};
+
+static constexpr uint32_t batch_sizes[]    = {100, 1000, 10000};
+static constexpr uint32_t segment_counts[] = {8, 32, 128};
+
+static constexpr float size = .01f;
+
+// Spread over a 100x100 grid so consecutive primitives never share coordinates the compiler could hoist
+static glm::vec2 Position(uint32_t index) { return {(index % 100) * .02f - 1.f, ((index / 100) % 100) * .02f - 1.f}; }
+
+static const glm::vec4 inner {.2f, .4f, .8f, 1.f};
+static const glm::vec4 outter {1.f, 1.f, 1.f, 1.f};
+
+static const PrimitiveCase primitives[] = {
+    {"DrawQuad", false, [](uint32_t i, uint32_t) { Renderer::DrawQuad(Position(i), {size, size}, inner); }},
+    {"DrawTri",
+     false,
+     [](uint32_t i, uint32_t) {
+       const glm::vec2 p = Position(i);
+       Renderer::DrawTri(p, p + glm::vec2(size, 0.f), p + glm::vec2(0.f, size), inner);
+     }},
+    {"DrawLine", false, [](uint32_t i, uint32_t) { Renderer::DrawLine(Position(i), Position(i) + size, inner); }},
+    {"DrawLineWide",
+     false,
+     [](uint32_t i, uint32_t) { Renderer::DrawLine(Position(i), Position(i) + size, size * .1f, inner); }},
+    {"OutlineQuad", false, [](uint32_t i, uint32_t) { Renderer::OutlineQuad(Position(i), {size, size}, inner); }},
+    {"OutlineTri",
+     false,
+     [](uint32_t i, uint32_t) {
+       const glm::vec2 p = Position(i);
+       Renderer::OutlineTri(p, p + glm::vec2(size, 0.f), p + glm::vec2(0.f, size), size * .1f, inner);
+     }},
+    {"BorderTri",
+     false,
+     [](uint32_t i, uint32_t) {
+       const glm::vec2 p = Position(i);
+       Renderer::BorderTri(p, p + glm::vec2(size, 0.f), p + glm::vec2(0.f, size), size * .1f, inner, outter);
+     }},
+    {"DrawCircle", true, [](uint32_t i, uint32_t s) { Renderer::DrawCircle(Position(i), size, s, inner); }},
+    {"OutlineCircle",
+     true,
+     [](uint32_t i, uint32_t s) { Renderer::OutlineCircle(Position(i), size, s, size * .1f, inner); }},
+    {"BorderCircle",
+     true,
+     [](uint32_t i, uint32_t s) { Renderer::BorderCircle(Position(i), size, s, size * .1f, inner, outter); }},
+    {"BorderSemicircle",
+     true,
+     [](uint32_t i, uint32_t s) {
+       Renderer::BorderSemicircle(Position(i), size, 0.f, glm::pi<float>(), s, size * .1f, inner, outter);
+     }},
+    {"BorderSemicircleCustomCenterInside",
+     true,
+     [](uint32_t i, uint32_t s) {
+       const glm::vec2 p = Position(i);
+       Renderer::BorderSemicircleCustomCenterInside(
+           p, p + size * .5f, size, 0.f, glm::pi<float>(), s, size * .1f, inner, outter);
+     }},
+    {"BorderSemicircleCustomCenterOutside",
+     true,
+     [](uint32_t i, uint32_t s) {
+       const glm::vec2 p = Position(i);
+       Renderer::BorderSemicircleCustomCenterOutside(
+           p, p - size * .5f, size, 0.f, glm::pi<float>(), s, size * .1f, inner, outter);
+     }},
+};
+
+static NullBackend     null_backend;
+static SoftwareBackend software_backend;
+static bool            use_gl       = true;
+static bool            use_software = false;
+
+static BenchResult RunCase(const PrimitiveCase& primitive, uint32_t segments, uint32_t batch, double min_time) {
+  using clock = std::chrono::steady_clock;
+
+  const Renderer::Stats before = Renderer::GetStats();
+
+  double   draw_time = 0., submit_time = 0., finish_time = 0.;
+  uint64_t iterations = 0;
+
+  // The first batch warms caches and the driver's buffer allocations and is not counted
+  for (bool warmup = true; warmup || draw_time + submit_time < min_time; warmup = false) {
+    const auto start = clock::now();
+
+    Renderer::BeginBatch();
+    for (uint32_t i = 0; i < batch; i++) primitive.draw(i, segments);
+
+    const auto drawn = clock::now();
+
+    Renderer::EndBatch();
+    Renderer::FlushBatch();
+
+    const auto submitted = clock::now();
+
+    // Keeps the driver from queueing unbounded work, timed separately from the draws
+    if (use_gl) glFinish();
+    if (use_software) software_backend.Finish();
+
+    const auto finished = clock::now();
+
+    if (warmup) continue;
+
+    draw_time += std::chrono::duration<double>(drawn - start).count();
+    submit_time += std::chrono::duration<double>(submitted - drawn).count();
+    finish_time += std::chrono::duration<double>(finished - submitted).count();
+    iterations++;
+  }
+
+  const Renderer::Stats after = Renderer::GetStats();
+
+  // The warmup batch is part of the counter deltas
+  const double primitives = (double)batch * (iterations + 1);
+  const double vertices   = (after.tri_vertex_count - before.tri_vertex_count) +
+                          (after.line_vertex_count - before.line_vertex_count);
+  const double indices = (after.tri_index_count - before.tri_index_count) +
+                         (after.line_index_count - before.line_index_count);
+
+  return {primitive.name,
+          primitive.segmented ? segments : 0,
+          batch,
+          iterations,
+          draw_time * 1e9 / (batch * iterations),
+          submit_time * 1e9 / (batch * iterations),
+          finish_time * 1e9 / (batch * iterations),
+          vertices * sizeof(Vertex) / primitives,
+          indices * sizeof(uint32_t) / primitives,
+          (after.draw_calls - before.draw_calls) / (double)(iterations + 1)};
+}
+
+static void WriteJson(std::ostream&                   out,
+                      const std::string&              label,
+                      const char*                     context,
+                      const std::string&              renderer,
+                      const std::vector<BenchResult>& results) {
+  out << "{\n  \"label\": \"" << label << "\",\n  \"context\": \"" << context << "\",\n  \"renderer\": \""
+      << renderer << "\",\n";
+
+  if (!use_gl && !use_software) {
+    out << "  \"checksum\": \"" << std::hex << null_backend.Counters().checksum << std::dec << "\",\n";
+  }
+
+  out << "  \"results\": [\n";
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto& result = results[i];
+
+    out << "    {\"primitive\": \"" << result.primitive << "\", \"segments\": " << result.segments
+        << ", \"batch\": " << result.batch << ", \"iterations\": " << result.iterations
+        << ", \"primitives_per_second\": " << 1e9 / result.draw_ns << ", \"draw_ns\": " << result.draw_ns
+        << ", \"submit_ns\": " << result.submit_ns << ", \"finish_ns\": " << result.finish_ns
+        << ", \"vertex_bytes\": " << result.vertex_bytes
+        << ", \"index_bytes\": " << result.index_bytes << ", \"draw_calls\": " << result.draw_calls << "}"
+        << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+
+  out << "  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+  const char* context     = "egl";
+  uint32_t    threads     = 0;
+  double      min_time    = .2;
+  std::string label       = "";
+  std::string output_path = "";
+
+  for (int i = 1; i < argc; i += 2) {
+    const std::string_view option = argv[i];
+    if (i + 1 == argc) Logger::Die("Missing value for " + std::string(option));
+
+    if (option == "--context") {
+      context = argv[i + 1];
+
+    } else if (option == "--threads") {
+      threads = (uint32_t)std::atoi(argv[i + 1]);
+
+    } else if (option == "--min-time-ms") {
+      min_time = std::atof(argv[i + 1]) / 1000.;
+
+    } else if (option == "--label") {
+      label = argv[i + 1];
+
+    } else if (option == "--output") {
+      output_path = argv[i + 1];
+
+    } else {
+      Logger::Die("Unknown option " + std::string(option));
+    }
+  }
+
+  const std::string_view context_name = context;
+  if (context_name != "egl" && context_name != "osmesa" && context_name != "null" && context_name != "software") {
+    Logger::Die("Unknown context " + std::string(context_name));
+  }
+
+  use_software = context_name == "software";
+  use_gl       = context_name != "null" && !use_software;
+
+  GLFWwindow* window   = nullptr;
+  std::string renderer = "null";
+
+  if (use_gl) {
+    // Same context setup as Application::LaunchHeadless, so no display or window system is needed
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (!glfwInit()) Logger::Die("Failed to initialize GLFW");
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+                   context_name == "osmesa" ? GLFW_OSMESA_CONTEXT_API : GLFW_EGL_CONTEXT_API);
+
+    window = glfwCreateWindow(64, 64, "pixel_bench", nullptr, nullptr);
+    if (!window) Logger::Die("Failed to create a headless context");
+
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    glewExperimental = GL_TRUE;
+    if (!!glewInit()) Logger::Die("GLEW initialization failed");
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    renderer = (const char*)glGetString(GL_RENDERER);
+
+  } else if (use_software) {
+    software_backend.Create({1280, 720}, threads);
+    Renderer::SetBackend(&software_backend);
+
+    renderer = "software, " + std::to_string(software_backend.Threads()) + " threads";
+
+  } else {
+    Renderer::SetBackend(&null_backend);
+  }
+
+  Renderer::Init();
+  Renderer::UseCamera(OrthographicCamera(1.f, 1.f));
+
+  std::vector<BenchResult> results;
+
+  for (const auto& primitive : primitives) {
+    for (uint32_t batch : batch_sizes) {
+      if (!primitive.segmented) {
+        results.push_back(RunCase(primitive, 0, batch, min_time));
+        continue;
+      }
+
+      for (uint32_t segments : segment_counts) results.push_back(RunCase(primitive, segments, batch, min_time));
+    }
+  }
+
+  if (output_path.empty()) {
+    WriteJson(std::cout, label, context, renderer, results);
+
+  } else {
+    std::ofstream file(output_path);
+    if (!file) Logger::Die("Cannot open " + output_path);
+
+    WriteJson(file, label, context, renderer, results);
+  }
+
+  Renderer::Delete();
+
+  if (use_gl) {
+    glfwDestroyWindow(window);
+    glfwTerminate();
+  }
+}
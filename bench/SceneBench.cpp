@@ -0,0 +1,548 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.hpp"
+#include "Pixel/Application.hpp"
+#include "Pixel/OrthographicCamera.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Pixel/Texture.hpp"
+#include "Util/Logger.hpp"
+
+using namespace Pixel;
+
+// Runs standard stress scenes headless for a fixed number of frames and reports frame time percentiles, draw calls,
+// vertex and index bytes and peak RSS per scene as JSON or CSV. Scenes advance by a fixed 1/60 s per frame no matter
+// how long frames take, so every run draws the same geometry. With --baseline, every lower-is-better value is
+// compared against a previous JSON report and the exit code is 1 when any of them regressed past the threshold.
+//
+//   pixel_scene_bench [--scene name] [--frames 600] [--warmup 60] [--context egl|osmesa] [--format json|csv]
+//                     [--output results.json] [--baseline baseline.json] [--threshold 10]
+
+static constexpr float timestep = 1.f / 60.f;
+static constexpr float aspect   = 16.f / 9.f;
+
+static const glm::uvec2 resolution = {1920, 1080};
+
+static std::string gl_renderer = "";
+
+static float Hash(uint32_t value) {
+  value = (value ^ 61u) ^ (value >> 16);
+  value *= 9u;
+  value ^= value >> 4;
+  value *= 0x27d4eb2du;
+  value ^= value >> 15;
+  return (value & 0xffffff) / (float)0xffffff;
+}
+
+class Scene {
+ public:
+  virtual ~Scene() = default;
+
+  virtual void Setup() {}
+  virtual void Render(float time) = 0;
+  virtual void ImGuiRender() {}
+  virtual void Release() {}
+
+ protected:
+  OrthographicCamera pCamera {1.f, aspect};
+};
+
+// 100k moving quads cycling through 32 textures, four times the available slots
+class SpritesScene : public Scene {
+ public:
+  void Setup() override {
+    for (uint32_t i = 0; i < 32; i++) pTextures[i].Load(glm::vec4 {Hash(i), Hash(i + 32), Hash(i + 64), 1.f});
+
+    for (uint32_t i = 0; i < count; i++) {
+      pBase[i]     = {Hash(i * 3) * 2.f * aspect - aspect, Hash(i * 3 + 1) * 2.f - 1.f};
+      pVelocity[i] = {Hash(i * 3 + 2) * .2f - .1f, Hash(i * 7) * .2f - .1f};
+    }
+  }
+
+  void Render(float time) override {
+    Renderer::UseCamera(pCamera);
+    Renderer::BeginBatch();
+
+    for (uint32_t i = 0; i < count; i++) {
+      const glm::vec2 position = pBase[i] + pVelocity[i] * std::sin(time + i);
+      Renderer::DrawQuad(position, {.01f, .01f}, {1.f, 1.f, 1.f, 1.f}, pTextures[i % 32]);
+    }
+
+    Renderer::EndBatch();
+    Renderer::FlushBatch();
+  }
+
+  void Release() override {
+    for (auto& texture : pTextures) texture.Release();
+  }
+
+ private:
+  static constexpr uint32_t count = 100000;
+
+  Texture                pTextures[32];
+  std::vector<glm::vec2> pBase     = std::vector<glm::vec2>(count);
+  std::vector<glm::vec2> pVelocity = std::vector<glm::vec2>(count);
+};
+
+// 50k bordered circles at 16 segments, the heaviest per-primitive vertex and index output the renderer has
+class CirclesScene : public Scene {
+ public:
+  void Render(float time) override {
+    Renderer::UseCamera(pCamera);
+    Renderer::BeginBatch();
+
+    for (uint32_t i = 0; i < count; i++) {
+      const glm::vec2 center {Hash(i * 2) * 2.f * aspect - aspect, Hash(i * 2 + 1) * 2.f - 1.f};
+      const float     radius = .006f + .004f * std::sin(time * 2.f + i);
+
+      Renderer::BorderCircle(center, radius, 16, .002f, {Hash(i), .4f, .8f, 1.f});
+    }
+
+    Renderer::EndBatch();
+    Renderer::FlushBatch();
+  }
+
+ private:
+  static constexpr uint32_t count = 50000;
+};
+
+// A 1M point line chart scrolled through the transform, so the per-frame work is only line submission
+class LineChartScene : public Scene {
+ public:
+  void Setup() override {
+    for (uint32_t i = 0; i < count; i++) {
+      const float x = i * (2.f * aspect / 100000.f) - aspect;
+      pPoints[i]    = {x, std::sin(x * 3.f) * .5f + (Hash(i) - .5f) * .1f};
+    }
+  }
+
+  void Render(float time) override {
+    Renderer::UseCamera(pCamera);
+    Renderer::SetTransform({-time * .5f, 0.f, 0.f});
+    Renderer::BeginBatch();
+
+    for (uint32_t i = 1; i < count; i++) Renderer::DrawLine(pPoints[i - 1], pPoints[i], {.3f, .9f, .4f, 1.f});
+
+    Renderer::EndBatch();
+    Renderer::FlushBatch();
+    Renderer::SetTransform({0.f, 0.f, 0.f});
+  }
+
+ private:
+  static constexpr uint32_t count = 1000000;
+
+  std::vector<glm::vec2> pPoints = std::vector<glm::vec2>(count);
+};
+
+// A static panel layout with a handful of ImGui windows on top, the typical tool or editor frame
+class UiScene : public Scene {
+ public:
+  void Render(float time) override {
+    Renderer::UseCamera(pCamera);
+    Renderer::BeginBatch();
+
+    for (uint32_t y = 0; y < 12; y++) {
+      for (uint32_t x = 0; x < 20; x++) {
+        const glm::vec2 position {x * .17f - aspect + .02f, y * .16f - .98f};
+
+        Renderer::DrawQuad(position, {.15f, .14f}, {.15f, .16f, .2f, 1.f});
+        Renderer::OutlineQuad(position, {.15f, .14f}, {.4f, .4f, .45f, 1.f});
+      }
+    }
+
+    Renderer::EndBatch();
+    Renderer::FlushBatch();
+  }
+
+  void Setup() override {
+    for (uint32_t i = 0; i < 64; i++) pHistory[i] = Hash(i);
+  }
+
+  void ImGuiRender() override {
+    for (uint32_t window = 0; window < 4; window++) {
+      char title[32];
+      std::snprintf(title, sizeof(title), "Panel %u", window);
+
+      ImGui::SetNextWindowPos(ImVec2(20.f + window * 470.f, 20.f), ImGuiCond_FirstUseEver);
+      ImGui::SetNextWindowSize(ImVec2(450.f, 600.f), ImGuiCond_FirstUseEver);
+      ImGui::Begin(title);
+
+      for (uint32_t row = 0; row < 20; row++) {
+        ImGui::Text("Property %u", row);
+        ImGui::SameLine(200.f);
+        ImGui::ProgressBar(Hash(window * 20 + row));
+      }
+
+      ImGui::Separator();
+      ImGui::SliderFloat("Value", &pValues[window], 0.f, 1.f);
+      ImGui::Checkbox("Enabled", &pEnabled[window]);
+      ImGui::Button("Apply");
+      ImGui::PlotLines("History", pHistory, 64);
+
+      ImGui::End();
+    }
+  }
+
+ private:
+  float pValues[4]   = {};
+  bool  pEnabled[4]  = {};
+  float pHistory[64] = {};
+};
+
+// A 300x300 tile world, far larger than the view, panned along a fixed path
+class CameraPanScene : public Scene {
+ public:
+  void Render(float time) override {
+    pCamera.setPosition({std::sin(time * .3f) * 100.f, std::cos(time * .2f) * 100.f, 0.f});
+    pCamera.setProjection(8.f, aspect);
+
+    Renderer::UseCamera(pCamera);
+    Renderer::BeginBatch();
+
+    for (uint32_t y = 0; y < tiles; y++) {
+      for (uint32_t x = 0; x < tiles; x++) {
+        const float shade = .2f + Hash(y * tiles + x) * .6f;
+        Renderer::DrawQuad({x - tiles * .5f, y - tiles * .5f}, {.95f, .95f}, {shade, shade * .8f, .3f, 1.f});
+      }
+    }
+
+    Renderer::EndBatch();
+    Renderer::FlushBatch();
+  }
+
+ private:
+  static constexpr uint32_t tiles = 300;
+};
+
+struct SceneEntry {
+  const char* name;
+  std::unique_ptr<Scene> (*create)();
+};
+
+static const SceneEntry scenes[] = {
+    {"sprites", []() -> std::unique_ptr<Scene> { return std::make_unique<SpritesScene>(); }},
+    {"bordered_circles", []() -> std::unique_ptr<Scene> { return std::make_unique<CirclesScene>(); }},
+    {"line_chart", []() -> std::unique_ptr<Scene> { return std::make_unique<LineChartScene>(); }},
+    {"ui", []() -> std::unique_ptr<Scene> { return std::make_unique<UiScene>(); }},
+    {"camera_pan", []() -> std::unique_ptr<Scene> { return std::make_unique<CameraPanScene>(); }},
+};
+
+struct SceneResult {
+  std::string scene;
+  uint32_t    frames       = 0;
+  double      mean_ms      = 0.;
+  double      p50_ms       = 0.;
+  double      p95_ms       = 0.;
+  double      p99_ms       = 0.;
+  double      max_ms       = 0.;
+  double      draw_calls   = 0.;  // Per frame
+  double      vertex_bytes = 0.;  // Per frame
+  double      index_bytes  = 0.;  // Per frame
+  uint64_t    peak_rss_kb  = 0;
+};
+
+// Lower is better for every one of these and for peak_rss_kb, which is what makes a single threshold meaningful. The
+// peak is an integer, so Compare checks it on its own.
+static constexpr std::pair<const char*, double SceneResult::*> compared_fields[] = {
+    {"mean_ms", &SceneResult::mean_ms},
+    {"p50_ms", &SceneResult::p50_ms},
+    {"p95_ms", &SceneResult::p95_ms},
+    {"p99_ms", &SceneResult::p99_ms},
+    {"draw_calls", &SceneResult::draw_calls},
+    {"vertex_bytes", &SceneResult::vertex_bytes},
+    {"index_bytes", &SceneResult::index_bytes},
+};
+
+// Linux resets the high water mark when 5 is written to clear_refs, elsewhere the peak covers the whole process
+static void ResetPeakRss() { std::ofstream("/proc/self/clear_refs") << "5"; }
+
+static uint64_t PeakRssKb() {
+  std::ifstream status("/proc/self/status");
+  std::string   line;
+
+  while (std::getline(status, line)) {
+    if (line.rfind("VmHWM:", 0) == 0) return std::strtoull(line.c_str() + 6, nullptr, 10);
+  }
+
+  return 0;
+}
+
+class SceneBench : public Application {
+ public:
+  SceneBench(Scene& scene, uint32_t warmup, uint32_t frames) : pScene(scene), pWarmup(warmup), pFrames(frames) {}
+
+  SceneResult Result(const std::string& name) const {
+    std::vector<float> sorted = pFrameTimes;
+    std::sort(sorted.begin(), sorted.end());
+
+    const auto percentile = [&](double p) {
+      return sorted.empty() ? 0. : sorted[std::min<size_t>(sorted.size() - 1, (size_t)(p / 100. * sorted.size()))];
+    };
+
+    double total = 0.;
+    for (float frame_time : sorted) total += frame_time;
+
+    const double frames = std::max<size_t>(sorted.size(), 1);
+
+    return {name,
+            (uint32_t)sorted.size(),
+            total * 1000. / frames,
+            percentile(50.) * 1000.,
+            percentile(95.) * 1000.,
+            percentile(99.) * 1000.,
+            (sorted.empty() ? 0. : sorted.back()) * 1000.,
+            (pEnd.draw_calls - pStart.draw_calls) / (double)pFrames,
+            ((pEnd.tri_vertex_count - pStart.tri_vertex_count) + (pEnd.line_vertex_count - pStart.line_vertex_count)) *
+                (double)sizeof(Vertex) / pFrames,
+            ((pEnd.tri_index_count - pStart.tri_index_count) + (pEnd.line_index_count - pStart.line_index_count)) *
+                (double)sizeof(uint32_t) / pFrames,
+            PeakRssKb()};
+  }
+
+ protected:
+  rcode pOnLaunch() override {
+    gl_renderer = (const char*)glGetString(GL_RENDERER);
+
+    Renderer::Init();
+    pScene.Setup();
+
+    return rcode::ok;
+  }
+
+  // Stats are sampled before the first measured frame renders and before the one after the last, so exactly
+  // pFrames renders fall between them. et() here is the duration of the previous frame.
+  rcode pOnUpdate() override {
+    if (pFrame > pWarmup) pFrameTimes.push_back(et());
+
+    if (pFrame == pWarmup) pStart = Renderer::GetStats();
+
+    if (pFrame == pWarmup + pFrames) {
+      pEnd = Renderer::GetStats();
+      Close();
+    }
+
+    pFrame++;
+    return rcode::ok;
+  }
+
+  rcode pOnImGuiRender() override {
+    pScene.ImGuiRender();
+    return rcode::ok;
+  }
+
+  rcode pOnRender() override {
+    pScene.Render((pFrame - 1) * timestep);
+    return rcode::ok;
+  }
+
+  rcode pOnClose() override {
+    pScene.Release();
+    Renderer::Delete();
+
+    return rcode::ok;
+  }
+
+ private:
+  Scene&   pScene;
+  uint32_t pWarmup = 0;
+  uint32_t pFrames = 0;
+  uint32_t pFrame  = 0;
+
+  std::vector<float> pFrameTimes;
+  Renderer::Stats    pStart = {};
+  Renderer::Stats    pEnd   = {};
+};
+
+static void WriteJson(std::ostream& out, const std::vector<SceneResult>& results) {
+  out << "{\n  \"renderer\": \"" << gl_renderer << "\",\n  \"scenes\": [\n";
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto& result = results[i];
+
+    out << "    {\"scene\": \"" << result.scene << "\", \"frames\": " << result.frames
+        << ", \"mean_ms\": " << result.mean_ms << ", \"p50_ms\": " << result.p50_ms << ", \"p95_ms\": " << result.p95_ms
+        << ", \"p99_ms\": " << result.p99_ms << ", \"max_ms\": " << result.max_ms
+        << ", \"draw_calls\": " << result.draw_calls << ", \"vertex_bytes\": " << result.vertex_bytes
+        << ", \"index_bytes\": " << result.index_bytes << ", \"peak_rss_kb\": " << result.peak_rss_kb << "}"
+        << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+
+  out << "  ]\n}\n";
+}
+
+static void WriteCsv(std::ostream& out, const std::vector<SceneResult>& results) {
+  out << "scene,frames,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,draw_calls,vertex_bytes,index_bytes,peak_rss_kb\n";
+
+  for (const auto& result : results) {
+    out << result.scene << "," << result.frames << "," << result.mean_ms << "," << result.p50_ms << ","
+        << result.p95_ms << "," << result.p99_ms << "," << result.max_ms << "," << result.draw_calls << ","
+        << result.vertex_bytes << "," << result.index_bytes << "," << result.peak_rss_kb << "\n";
+  }
+}
+
+// Reads back the one-scene-per-line layout WriteJson produces, not arbitrary JSON
+static std::vector<SceneResult> ReadBaseline(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) Logger::Die("Cannot open baseline " + path);
+
+  const auto field = [](const std::string& line, std::string_view key) -> std::string {
+    const std::string quoted = "\"" + std::string(key) + "\": ";
+    const size_t      start  = line.find(quoted);
+    if (start == std::string::npos) return "";
+
+    const size_t begin = start + quoted.size();
+    return line.substr(begin, line.find_first_of(",}", begin) - begin);
+  };
+
+  std::vector<SceneResult> results;
+  std::string              line;
+
+  while (std::getline(file, line)) {
+    std::string scene = field(line, "scene");
+    if (scene.size() < 2) continue;
+
+    SceneResult result;
+    result.scene = scene.substr(1, scene.size() - 2);
+
+    for (const auto& [name, member] : compared_fields) result.*member = std::atof(field(line, name).c_str());
+    result.peak_rss_kb = std::strtoull(field(line, "peak_rss_kb").c_str(), nullptr, 10);
+
+    results.push_back(result);
+  }
+
+  return results;
+}
+
+static bool Compare(const std::vector<SceneResult>& baseline,
+                    const std::vector<SceneResult>& results,
+                    double                          threshold) {
+  bool regressed = false;
+
+  for (const auto& result : results) {
+    const auto base = std::find_if(
+        baseline.begin(), baseline.end(), [&](const SceneResult& entry) { return entry.scene == result.scene; });
+
+    if (base == baseline.end()) {
+      std::cerr << result.scene << ": not in baseline\n";
+      continue;
+    }
+
+    const auto compare = [&](const char* name, double before, double after) {
+      const double change = before > 0. ? (after - before) / before * 100. : 0.;
+      const bool   worse  = change > threshold;
+
+      regressed |= worse;
+
+      std::fprintf(stderr,
+                   "%-18s %-13s %12.3f -> %12.3f  %+7.1f%%%s\n",
+                   result.scene.c_str(),
+                   name,
+                   before,
+                   after,
+                   change,
+                   worse ? "  REGRESSION" : "");
+    };
+
+    for (const auto& [name, member] : compared_fields) compare(name, (*base).*member, result.*member);
+    compare("peak_rss_kb", (double)base->peak_rss_kb, (double)result.peak_rss_kb);
+  }
+
+  return !regressed;
+}
+
+int main(int argc, char** argv) {
+  std::string     only      = "";
+  uint32_t        frames    = 600;
+  uint32_t        warmup    = 60;
+  HeadlessContext context   = HeadlessContext::egl;
+  std::string     format    = "json";
+  std::string     output    = "";
+  std::string     baseline  = "";
+  double          threshold = 10.;
+
+  for (int i = 1; i < argc; i += 2) {
+    const std::string_view option = argv[i];
+    if (i + 1 == argc) Logger::Die("Missing value for " + std::string(option));
+
+    const std::string value = argv[i + 1];
+
+    if (option == "--scene") {
+      only = value;
+
+    } else if (option == "--frames") {
+      frames = std::max(std::atoi(value.c_str()), 1);
+
+    } else if (option == "--warmup") {
+      warmup = std::max(std::atoi(value.c_str()), 0);
+
+    } else if (option == "--context") {
+      context = value == "osmesa" ? HeadlessContext::osmesa : HeadlessContext::egl;
+
+    } else if (option == "--format") {
+      format = value;
+
+    } else if (option == "--output") {
+      output = value;
+
+    } else if (option == "--baseline") {
+      baseline = value;
+
+    } else if (option == "--threshold") {
+      threshold = std::atof(value.c_str());
+
+    } else {
+      Logger::Die("Unknown option " + std::string(option));
+    }
+  }
+
+  std::vector<SceneResult> results;
+
+  for (const auto& entry : scenes) {
+    if (!only.empty() && only != entry.name) continue;
+
+    ResetPeakRss();
+
+    // A fresh application per scene, so no GL objects or allocations carry over between them
+    auto       scene = entry.create();
+    SceneBench bench(*scene, warmup, frames);
+
+    bench.Construct(resolution, {0, 0}, entry.name, {.05f, .05f, .05f, 1.f}, Antialiasing::none);
+    bench.LaunchHeadless(context);
+
+    results.push_back(bench.Result(entry.name));
+  }
+
+  if (results.empty()) Logger::Die("No scene named " + only);
+
+  std::ofstream file;
+  if (!output.empty()) {
+    file.open(output);
+    if (!file) Logger::Die("Cannot open " + output);
+  }
+
+  std::ostream& out = output.empty() ? std::cout : file;
+
+  if (format == "csv") {
+    WriteCsv(out, results);
+
+  } else {
+    WriteJson(out, results);
+  }
+
+  if (!baseline.empty()) return Compare(ReadBaseline(baseline), results, threshold) ? 0 : 1;
+}
@@ -20,6 +20,19 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define PIXEL_APPLICATION_HPP
 
 #include "pch.hpp"
+#include "Pixel/CommandRecording.hpp"
+#include "Pixel/DynamicResolution.hpp"
+#include "Pixel/FrameCapture.hpp"
+#include "Pixel/FramePacket.hpp"
+#include "Pixel/GlBackend.hpp"
+#include "Pixel/JobSystem.hpp"
+#include "Pixel/OrthographicCamera.hpp"
+#include "Pixel/PerfHud.hpp"
+#include "Pixel/PostProcess.hpp"
+#include "Pixel/RenderTarget.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Util/Metrics.hpp"
+#include "Util/SpscQueue.hpp"
 
 namespace std {
   template <typename T>
@@ -35,6 +48,51 @@ namespace Pixel {
     error = 2,
   };
 
+  enum class Antialiasing : uint8_t {
+    none    = 0,
+    msaa_2x = 1,
+    msaa_4x = 2,
+    msaa_8x = 3,
+    fxaa    = 4,
+  };
+
+  uint32_t AntialiasingSamples(Antialiasing antialiasing);
+
+  enum class HeadlessContext : uint8_t {
+    egl    = 0,  // EGL surfaceless, uses the GPU driver when there is one
+    osmesa = 1,  // Mesa software rasterizer, needs neither a display nor a GPU
+  };
+
+  struct TiledExportSettings {
+    glm::uvec2            resolution = {};
+    std::filesystem::path output     = "export.png";
+    uint32_t              tile_size  = 1024;  // Clamped to the device limits, one row of tiles is held in memory
+  };
+
+  enum class VSync : uint8_t {
+    off      = 0,
+    on       = 1,
+    adaptive = 2,  // Tears rather than waiting another interval when a frame is late, plain vsync where unsupported
+  };
+
+  struct FramePacingSettings {
+    VSync vsync      = VSync::on;
+    float target_fps = 0.f;  // Frame limiter, 0 leaves the rate to vsync
+
+    // The limiter sleeps until this close to the deadline and spins for the rest, sleeps overshoot by up to the
+    // scheduler's wakeup latency
+    float spin_time = .001f;
+  };
+
+  struct FixedTimestepSettings {
+    float    step      = 1.f / 60.f;
+    uint32_t max_steps = 8;  // Per frame, time beyond this is dropped so a slow step cannot snowball into slower frames
+
+    // Steps run on their own thread at their own rate instead of ahead of pOnUpdate. State then has to reach
+    // pOnRender through something like a TripleBuffer, and input is only safe to read from pOnUpdate.
+    bool threaded = false;
+  };
+
   struct Button {
     bool pressed  = false;
     bool held     = false;
@@ -176,6 +234,25 @@ namespace Pixel {
     BUTTON_8 = 7
   };
 
+  enum class InputEventType : uint8_t {
+    key          = 0,
+    mouse_button = 1,
+    mouse_move   = 2,
+    mouse_scroll = 3,
+    mouse_enter  = 4,
+  };
+
+  struct InputEvent {
+    InputEventType type    = InputEventType::key;
+    bool           pressed = false;  // Press or release for keys and buttons, entering or leaving for mouse_enter
+    uint16_t       code    = 0;      // KeyboardKey or MouseButton value
+
+    // The new normalized position for mouse_move, the scroll offsets for mouse_scroll
+    glm::vec2 value = {};
+
+    std::chrono::steady_clock::time_point time = {};  // When the platform thread received it
+  };
+
   class Mouse {
    public:
     friend class Application;
@@ -186,21 +263,17 @@ namespace Pixel {
     inline const Button& button(const MouseButton& button) const { return state[(uint8_t)button]; }
 
    private:
-    Button state[8]     = {};
-    bool   state_old[8] = {};
-    bool   state_new[8] = {};
+    Button state[8] = {};
   };
 
   class Keyboard {
    public:
     friend class Application;
 
-    inline const Button& key(const KeyboardKey& key) const { return state[(uint8_t)key]; }
+    inline const Button& key(const KeyboardKey& key) const { return state[(uint16_t)key]; }
 
    private:
-    Button state[512]     = {};
-    bool   state_old[512] = {};
-    bool   state_new[512] = {};
+    Button state[512] = {};
   };
 
   class Application {
@@ -208,8 +281,22 @@ namespace Pixel {
     void Construct(const glm::uvec2& size,
                    const glm::uvec2& position,
                    const char*       name,
-                   glm::vec4         clear_color = glm::vec4(.0f, .0f, .0f, 1.00f));
+                   glm::vec4         clear_color  = glm::vec4(.0f, .0f, .0f, 1.00f),
+                   Antialiasing      antialiasing = Antialiasing::msaa_4x);
+    // Must come before Launch. A depth of 1 or 2 moves pOnUpdate, pOnImGuiRender and pOnRender onto an update thread
+    // that runs up to that many frames ahead of the graphics thread, which keeps the GL context and draws what they
+    // submitted. Those callbacks must then leave OpenGL alone: textures and targets are made in pOnLaunch, which like
+    // pOnClose stays on the graphics thread. Drawing goes through the OpenGL backend whatever Renderer was given.
+    void     SetFramePipelining(uint32_t depth);
+    uint32_t FramePipelining() const;
+
+    // Takes effect from the next frame, headless applications never wait for vsync. Frame to frame jitter is recorded
+    // as the frame.jitter metric either way.
+    void                       SetFramePacing(const FramePacingSettings& settings);
+    const FramePacingSettings& FramePacing() const;
+
     void Launch(bool background = false);
+    void LaunchHeadless(HeadlessContext context = HeadlessContext::egl, bool background = false);
     void Close();
     void EnsureClosed();
 
@@ -223,11 +310,38 @@ namespace Pixel {
     static void pHandleMouseEnter(GLFWwindow* window, int enter);
     static void pHandleKeyboardKey(GLFWwindow* window, int key, int scancode, int action, int mods);
 
+    void pPushInput(InputEvent event);
+    void pFlushHeldMotion(uint32_t reserve);
+    void pProcessInput();
+
     void pPlatformThread();
+    void pHeadlessThread();
     void pGraphicsThread();
 
+    GLuint pOutputFramebuffer() const;
+
+    void pUpdateThread();
+    void pUpdateFrame(FramePacket& frame);
+    void pSubmitWorld();
+    void pDrawFrame(FramePacket& frame, bool replay, std::chrono::steady_clock::time_point work_start);
+    void pFinishFrame(FramePacket& frame);
+    void pEndFrame();
+
+    void pApplySwapInterval();
+    void pLimitFrameRate();
+
+    void pBeginWorldPass(const FramePacket& frame);
+    void pEndWorldPass();
+
+    void pExportTiled();
+
+    void pFixedUpdateThread();
+    void pStartFixedThread();
+    void pStopFixedThread();
+
    protected:
     virtual rcode pOnUpdate();
+    virtual rcode pOnFixedUpdate(float dt);
     virtual rcode pOnLaunch();
     virtual rcode pOnImGuiRender();
     virtual rcode pOnRender();
@@ -250,11 +364,62 @@ namespace Pixel {
     const Mouse&    MouseState() const;
     const Keyboard& KeyboardState() const;
 
+    // This frame's input in the order it arrived, next to the button state above which only keeps the outcome
+    const std::vector<InputEvent>& InputEvents() const;
+
     float    et() const;
     uint32_t fps() const;
 
+    // The engine's shared job system, pOnUpdate and the other callbacks can spread their work over it and Wait
+    // inside them, the calling thread helps rather than blocks
+    JobSystem& Jobs();
+
+    const MetricsRegistry& Metrics() const;
+    MetricsRegistry&       Metrics();
+    uint32_t               FrameTimeMetric() const { return pFrameTimeMetric; }
+
+    // pOnFixedUpdate runs zero or more times each frame, before pOnUpdate, so the simulation advances by whole steps
+    // whatever the frame rate. InterpolationAlpha is how far past the last step the frame is, in [0, 1), for
+    // pOnRender to blend the last two steps with.
+    void                         EnableFixedTimestep(const FixedTimestepSettings& settings = {});
+    void                         DisableFixedTimestep();
+    bool                         FixedTimestep() const;
+    const FixedTimestepSettings& FixedTimestepConfig() const;
+    float                        InterpolationAlpha() const;
+
+    void                     EnableDynamicResolution(const DynamicResolutionSettings& settings = {});
+    void                     DisableDynamicResolution();
+    float                    ResolutionScale() const;
+    const glm::uvec2&        RenderResolution() const;
+    const DynamicResolution& ResolutionController() const;
+
+    bool                Headless() const;
+    const RenderTarget& HeadlessTarget() const;
+
+    // Requests take effect from the next frame. These read the update side's view of the capture, so they are safe
+    // from pOnUpdate while the capture itself runs on the graphics thread.
+    void                   StartCapture(const CaptureSettings& settings);
+    void                   StopCapture();
+    bool                   Capturing() const;
+    const CaptureSettings& CaptureConfig() const;
+    uint64_t               CapturedFrames() const;
+
+    // Records the Renderer calls of the next frames into a file pixel_replay can play back, 0 frames records until
+    // StopRecording
+    void                   StartRecording(const std::filesystem::path& filepath, uint32_t frames = 0);
+    void                   StopRecording();
+    bool                   Recording() const;
+    const CommandRecorder& Recorder() const;
+
+    void ExportTiled(const OrthographicCamera& camera, const TiledExportSettings& settings);
+    bool Exporting() const;
+
+    void ShowPerfHud(bool visible = true);
+    bool PerfHudVisible() const;
+    void SetPerfHudKey(Pixel::KeyboardKey key);  // KEY_UNKNOWN, the default, leaves the HUD without a hotkey
+
    private:
-    std::string pWindowTittle;
+    char pWindowTitle[256] = {};
 
     bool pHasBeenClosed      = false;
     bool pHasBeenConstructed = false;
@@ -262,19 +427,36 @@ namespace Pixel {
     std::atomic<bool> pThreadRunning {false};
     std::atomic<bool> pWantsToClose {false};
 
-    std::chrono::system_clock::time_point pClock1;
-    std::chrono::system_clock::time_point pClock2;
+    std::chrono::steady_clock::time_point pClock1;
+    std::chrono::steady_clock::time_point pClock2;
     std::chrono::duration<float>          pElapsedTimer;
 
+    FramePacingSettings                   pPacing        = {};
+    FramePacingSettings                   pPendingPacing = {};
+    std::atomic<bool>                     pPacingRequested {false};
+    std::chrono::steady_clock::time_point pNextFrame = {};  // Limiter deadline
+
     GLFWwindow* pWindow     = nullptr;
     std::string pWindowName = "Application";
 
-    glm::vec4 pClearColor = {.0f, .0f, .0f, 1.f};
-
-    float    pElapsedTime = 0.0f;
-    float    pFrameTimer  = 0.0f;
-    uint32_t pFrameCount  = 0;
-    uint32_t pFrameRate   = 0;
+    glm::vec4    pClearColor  = {.0f, .0f, .0f, 1.f};
+    Antialiasing pAntialiasing = Antialiasing::msaa_4x;
+
+    float pElapsedTime = 0.0f;
+    float pTitleTimer  = 0.0f;
+
+    MetricsRegistry pMetrics            = {};
+    uint32_t        pFrameTimeMetric    = 0;
+    uint32_t        pUpdateTimeMetric   = 0;
+    uint32_t        pImGuiTimeMetric    = 0;
+    uint32_t        pRenderTimeMetric   = 0;
+    uint32_t        pGpuTimeMetric      = 0;
+    uint32_t        pFixedStepsMetric   = 0;
+    uint32_t        pJitterMetric       = 0;
+    uint32_t        pInputDroppedMetric = 0;
+    uint32_t        pFirstCounterMetric = 0;
+    uint32_t        pFirstFlushMetric   = 0;
+    Renderer::Stats pLastStats          = {};
 
     glm::uvec2 pFrameBufferSize = {};
     glm::uvec2 pWindowSize      = {};
@@ -283,7 +465,73 @@ namespace Pixel {
     Mouse    pMouse    = {};
     Keyboard pKeyboard = {};
 
+    // Written by the platform thread's callbacks and drained once per frame by whichever thread runs pOnUpdate
+    SpscQueue<InputEvent, 1024> pInputQueue;
+    std::vector<InputEvent>     pInputEvents;
+    std::vector<Button*>        pChangedButtons;
+    std::atomic<uint32_t>       pInputDropped {0};  // Taken since the last frame
+
+    // Motion the platform thread is holding back while the queue is nearly full, only ever touched by that thread
+    static constexpr uint32_t pMotionReserve = 64;
+
+    InputEvent pHeldMove   = {};
+    InputEvent pHeldScroll = {};
+    bool       pMoveHeld   = false;
+    bool       pScrollHeld = false;
+
     bool pHasMouseFocus = false;
+
+    FixedTimestepSettings pFixedSettings        = {};
+    FixedTimestepSettings pPendingFixedSettings = {};
+    std::atomic<bool>     pFixedRequested {false};
+    std::atomic<bool>     pFixedStopRequested {false};
+    bool                  pFixedEnabled       = false;
+    float                 pFixedAccumulator   = 0.f;
+    float                 pInterpolationAlpha = 0.f;
+
+    std::thread                                 pFixedThread;
+    std::atomic<bool>                           pFixedThreadRunning {false};
+    std::atomic<uint32_t>                       pFixedSteps {0};     // Taken since the last frame
+    std::atomic<std::chrono::steady_clock::rep> pLastFixedStep {0};  // When the newest threaded step was due
+
+    bool              pDynamicResolutionEnabled = false;
+    DynamicResolution pDynamicResolution        = {};
+    RenderTarget      pWorldTarget              = {};
+    FullscreenPass    pBlitPass                 = {};
+    FullscreenPass    pFxaaPass                 = {};
+    glm::uvec2        pRenderResolution         = {};  // Chosen by the update side of the frame
+    glm::uvec2        pDrawResolution           = {};  // What the graphics side is drawing at
+
+    uint32_t      pPipelineDepth = 0;
+    FrameQueue    pFrameQueue    = {};
+    FramePacket   pSerialFrame   = {};  // Carries the timings when not pipelining, never records
+    PacketBackend pPacketBackend = {};
+    GlBackend     pGlBackend     = {};
+
+    bool            pHeadless        = false;
+    HeadlessContext pHeadlessContext = HeadlessContext::egl;
+    RenderTarget    pHeadlessTarget  = {};
+
+    FrameCapture      pCapture         = {};
+    CaptureSettings   pPendingCapture  = {};
+    CaptureSettings   pCaptureSettings = {};  // As the update side sees it, pCapture belongs to the graphics thread
+    bool              pCapturing       = false;
+    std::atomic<bool> pCaptureRequested {false};
+    std::atomic<bool> pCaptureStopRequested {false};
+
+    CommandRecorder       pRecorder               = {};
+    std::filesystem::path pPendingRecording       = {};
+    uint32_t              pPendingRecordingFrames = 0;
+    std::atomic<bool>     pRecordingRequested {false};
+    std::atomic<bool>     pRecordingStopRequested {false};
+
+    TiledExportSettings pPendingExport               = {};
+    glm::mat4           pPendingExportViewProjection = glm::mat4(1.f);
+    std::atomic<bool>   pExportRequested {false};
+
+    PerfHud            pPerfHud = {};
+    std::atomic<bool>  pPerfHudVisible {false};
+    Pixel::KeyboardKey pPerfHudKey = Pixel::KeyboardKey::KEY_UNKNOWN;
   };
 }
 
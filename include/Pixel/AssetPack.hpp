@@ -0,0 +1,99 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_ASSETPACK_HPP
+#define PIXEL_ASSETPACK_HPP
+
+#include "pch.hpp"
+#include "Pixel/Shader.hpp"
+#include "Pixel/Texture.hpp"
+
+namespace Pixel {
+  // On-disk layout, shared between the runtime loader and the pixel_cook tool. Every offset is relative to the start
+  // of the file and every blob is aligned to pack_alignment, so texture levels can be handed to GL straight from the
+  // mapping.
+  constexpr uint32_t pack_magic     = 0x4b505850;  // "PXPK"
+  constexpr uint32_t pack_version   = 1;
+  constexpr uint32_t pack_alignment = 16;
+
+  enum class PackEntryType : uint32_t {
+    texture = 0,
+    shader  = 1,
+  };
+
+  struct PackHeader {
+    uint32_t magic        = pack_magic;
+    uint32_t version      = pack_version;
+    uint32_t entry_count  = 0;
+    uint32_t reserved     = 0;
+    uint64_t entry_offset = 0;
+  };
+
+  struct PackBlob {
+    uint64_t offset = 0;
+    uint64_t size   = 0;
+  };
+
+  struct PackEntry {
+    char          name[64]    = {};
+    PackEntryType type        = PackEntryType::texture;
+    TextureFormat format      = TextureFormat::rgba8;
+    uint32_t      width       = 0;
+    uint32_t      height      = 0;
+    uint32_t      blob_count  = 0;  // Mip levels for textures, vertex and fragment stages for shaders
+    uint32_t      reserved    = 0;
+    uint64_t      blob_offset = 0;
+  };
+
+  static_assert(sizeof(PackHeader) == 24);
+  static_assert(sizeof(PackBlob) == 16);
+  static_assert(sizeof(PackEntry) == 96);
+
+  class AssetPack {
+   public:
+    AssetPack()                            = default;
+    AssetPack(const AssetPack&)            = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+    ~AssetPack();
+
+    void Open(const std::string& filepath);
+    void Close();
+
+    bool Contains(std::string_view name) const;
+
+    void LoadTexture(std::string_view name, Texture& texture) const;
+    void LoadShader(std::string_view name, ShaderProgram& shader) const;
+
+   private:
+    const PackEntry& pFind(std::string_view name, PackEntryType type) const;
+    const PackBlob*  pBlobs(const PackEntry& entry) const;
+
+   private:
+    const uint8_t* pData = nullptr;
+    size_t         pSize = 0;
+
+#ifdef _WIN32
+    void* pFileHandle    = nullptr;
+    void* pMappingHandle = nullptr;
+#endif
+
+    std::unordered_map<std::string_view, const PackEntry*> pEntries;
+  };
+}
+
+#endif
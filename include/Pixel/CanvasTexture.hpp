@@ -0,0 +1,76 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_CANVASTEXTURE_HPP
+#define PIXEL_CANVASTEXTURE_HPP
+
+#include "pch.hpp"
+#include "Pixel/Texture.hpp"
+
+namespace Pixel {
+  // A CPU-writable RGBA8 texture. Writes are tracked as dirty rectangles and Upload() streams only those regions
+  // through one of two pixel unpack buffers, alternating every frame so the CPU never waits on a transfer that the GPU
+  // is still consuming. Row 0 is the bottom row, matching Texture::Load.
+  class CanvasTexture : public Texture {
+   public:
+    void Create(const glm::uvec2& size, const glm::vec4& color = {0.f, 0.f, 0.f, 1.f});
+    void Release();
+
+    const glm::uvec2& Size() const { return pSize; }
+
+    uint32_t*       Pixels() { return pPixels.data(); }
+    const uint32_t* Pixels() const { return pPixels.data(); }
+
+    uint32_t GetPixel(uint32_t x, uint32_t y) const { return pPixels[y * pSize.x + x]; }
+    void     SetPixel(uint32_t x, uint32_t y, uint32_t color);
+    void     SetPixel(uint32_t x, uint32_t y, const glm::vec4& color);
+    void     Fill(const glm::uvec2& position, const glm::uvec2& size, uint32_t color);
+
+    void MarkDirty(const glm::uvec2& position, const glm::uvec2& size);
+    void MarkAllDirty();
+
+    void Upload();
+
+    uint64_t UploadedBytes() const { return pUploadedBytes; }
+
+    static uint32_t PackColor(const glm::vec4& color);
+
+   private:
+    struct DirtyRect {
+      glm::uvec2 min = {};
+      glm::uvec2 max = {};  // Exclusive
+    };
+
+    static constexpr uint32_t pMaxDirtyRects = 16;
+
+    glm::uvec2            pSize = {};
+    std::vector<uint32_t> pPixels;
+
+    DirtyRect pDirty[pMaxDirtyRects] = {};
+    uint32_t  pDirtyCount            = 0;
+
+    GLuint   pBuffers[2]        = {};
+    GLsync   pFences[2]         = {};
+    uint64_t pBufferCapacity[2] = {};
+    uint32_t pBufferIndex       = 0;
+
+    uint64_t pUploadedBytes = 0;
+  };
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_COMMANDRECORDING_HPP
+#define PIXEL_COMMANDRECORDING_HPP
+
+#include "pch.hpp"
+#include "Pixel/RenderBackend.hpp"
+#include "Pixel/RenderTarget.hpp"
+#include "Pixel/Texture.hpp"
+
+namespace Pixel {
+  // A recording is this header followed by a stream of commands, each a one byte RenderCommand and then its
+  // arguments in declaration order, little endian with no padding. A new_frame command starts every frame.
+  constexpr uint32_t recording_magic   = 0x43525850;  // "PXRC"
+  constexpr uint32_t recording_version = 1;
+
+  struct RecordingHeader {
+    uint32_t magic       = recording_magic;
+    uint32_t version     = recording_version;
+    uint32_t width       = 0;  // Framebuffer size when the recording started
+    uint32_t height      = 0;
+    uint32_t frame_count = 0;
+    uint32_t reserved    = 0;
+  };
+
+  static_assert(sizeof(RecordingHeader) == 24);
+
+  enum class RenderCommand : uint8_t {
+    new_frame                               = 0,
+    begin_batch                             = 1,
+    end_batch                               = 2,
+    flush_batch                             = 3,
+    begin_target                            = 4,
+    end_target                              = 5,
+    draw_quad                               = 6,
+    draw_tri                                = 7,
+    draw_circle                             = 8,
+    draw_line                               = 9,
+    draw_wide_line                          = 10,
+    outline_quad                            = 11,
+    outline_tri                             = 12,
+    border_tri                              = 13,
+    outline_circle                          = 14,
+    border_circle                           = 15,
+    border_semicircle                       = 16,
+    border_semicircle_custom_center_inside  = 17,
+    border_semicircle_custom_center_outside = 18,
+    set_view_projection                     = 19,  // UseCamera is recorded as the matrix it sets
+    set_transform                           = 20,
+    set_view_projection_override            = 21,
+    clear_view_projection_override          = 22,
+    set_debug_view                          = 23,
+    begin_debug_view                        = 24,
+    end_debug_view                          = 25,
+    count                                   = 26,
+  };
+
+  // Writes every Renderer call made between Start and Stop, or for a set number of frames. Textures are recorded by
+  // identity along with their memory footprint, so a replay can stand in textures of the same size without the
+  // original images. Render targets are numbered in order of first use and record their size, format and sample count
+  // every time they are bound. Must be used from the thread that owns the renderer.
+  class CommandRecorder {
+   public:
+    void Start(const std::filesystem::path& filepath, const glm::uvec2& size, uint32_t frames = 0);  // 0 records on
+    void Stop();
+
+    bool     Active() const { return pActive; }
+    uint32_t FramesRecorded() const { return pFrames; }
+    uint64_t BytesRecorded() const { return pBytes + pBuffer.size(); }
+
+    void NewFrame();
+
+    template <typename... Args>
+    void Record(RenderCommand command, const Args&... args) {
+      if (!pActive) return;
+
+      pBuffer.push_back((uint8_t)command);
+      (pWrite(args), ...);
+
+      if (pBuffer.size() >= pFlushSize) pFlush();
+    }
+
+   private:
+    template <typename T>
+    void pWriteRaw(const T& value) {
+      const uint8_t* bytes = (const uint8_t*)&value;
+      pBuffer.insert(pBuffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void pWrite(bool value) { pWriteRaw((uint8_t)value); }
+    void pWrite(float value) { pWriteRaw(value); }
+    void pWrite(uint32_t value) { pWriteRaw(value); }
+    void pWrite(DebugView value) { pWriteRaw((uint8_t)value); }
+    void pWrite(const glm::vec2& value) { pWriteRaw(value); }
+    void pWrite(const glm::vec3& value) { pWriteRaw(value); }
+    void pWrite(const glm::vec4& value) { pWriteRaw(value); }
+    void pWrite(const glm::uvec2& value) { pWriteRaw(value); }
+    void pWrite(const glm::mat4& value) { pWriteRaw(value); }
+    void pWrite(const Texture& texture);
+    void pWrite(const RenderTarget& target);
+
+    void pFlush();
+
+   private:
+    // Texture references are 0 for Renderer::white_texture, 1 and up for textures in order of first use, and
+    // pTargetBit plus the target number for render targets. A texture's first use is written as pNewTexture followed
+    // by its memory footprint in bytes.
+    static constexpr size_t   pFlushSize  = 1 << 20;
+    static constexpr uint32_t pTargetBit  = 1u << 31;
+    static constexpr uint32_t pNewTexture = ~0u;
+
+    std::ofstream        pFile;
+    std::vector<uint8_t> pBuffer;
+    uint64_t             pBytes     = 0;
+    bool                 pActive    = false;
+    uint32_t             pFrames    = 0;
+    uint32_t             pMaxFrames = 0;
+
+    std::unordered_map<GLuint, uint32_t>              pTextures;  // GL name to reference
+    std::unordered_map<const RenderTarget*, uint32_t> pTargets;   // Target to its number
+    uint32_t                                          pTextureCount = 0;
+
+    friend class CommandPlayer;
+  };
+
+  // Plays a recording back through Renderer one frame at a time, with placeholder textures and fresh render targets
+  // standing in for the originals. The whole file is read up front so playback does no I/O.
+  class CommandPlayer {
+   public:
+    // Without GPU resources, textures and targets get no GL objects, for backends that do not need them
+    void Open(const std::string& filepath, bool gpu_resources = true);
+    void Release();
+
+    const glm::uvec2& Size() const { return pSize; }
+    uint32_t          Frames() const { return pFrameCount; }
+
+    bool PlayFrame();  // Issues the next frame's commands, false once the recording is exhausted
+    void Rewind();
+
+   private:
+    template <typename T>
+    T pRead() {
+      T value;
+      pReadBytes(&value, sizeof(T));
+
+      return value;
+    }
+
+    void pReadBytes(void* value, size_t size);
+
+    const Texture& pReadTexture();
+    RenderTarget&  pReadTarget();
+    void           pPlay(RenderCommand command);
+
+   private:
+    std::vector<uint8_t> pData;
+    size_t               pStart        = 0;
+    size_t               pCursor       = 0;
+    glm::uvec2           pSize         = {};
+    uint32_t             pFrameCount   = 0;
+    bool                 pGpuResources = true;
+
+    // Deques so the references Renderer keeps for nested targets stay valid as more are added
+    std::deque<Texture>      pTextures;
+    std::deque<RenderTarget> pTargets;
+  };
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_DYNAMICRESOLUTION_HPP
+#define PIXEL_DYNAMICRESOLUTION_HPP
+
+#include "pch.hpp"
+
+namespace Pixel {
+  enum class ScaleDecision : uint8_t {
+    hold     = 0,
+    increase = 1,
+    decrease = 2,
+  };
+
+  struct DynamicResolutionSettings {
+    float    target_frame_time = 1.f / 60.f;  // In seconds
+    float    min_scale         = .5f;
+    float    max_scale         = 1.f;
+    float    step              = .05f;  // Largest change applied in a single decision
+    float    headroom          = .85f;  // Scale only grows while frames stay under this fraction of the target
+    float    smoothing         = .1f;   // Weight of the newest sample in the moving average
+    uint32_t cooldown_frames   = 10;    // Frames to wait after a change before deciding again
+  };
+
+  // Picks the per-axis render scale from the slower of CPU and GPU frame time, shrinking proportionally to the
+  // overshoot (pixel cost grows with the square of the scale) and growing back one step at a time.
+  class DynamicResolution {
+   public:
+    void Configure(const DynamicResolutionSettings& settings);
+
+    ScaleDecision Update(float cpu_frame_time, float gpu_frame_time);
+
+    const DynamicResolutionSettings& Settings() const { return pSettings; }
+
+    float         Scale() const { return pScale; }
+    float         FrameTime() const { return pFrameTime; }
+    ScaleDecision LastDecision() const { return pLastDecision; }
+    uint64_t      Increases() const { return pIncreases; }
+    uint64_t      Decreases() const { return pDecreases; }
+
+   private:
+    DynamicResolutionSettings pSettings     = {};
+    float                     pScale        = 1.f;
+    float                     pFrameTime    = 0.f;
+    uint32_t                  pCooldown     = 0;
+    ScaleDecision             pLastDecision = ScaleDecision::hold;
+    uint64_t                  pIncreases    = 0;
+    uint64_t                  pDecreases    = 0;
+  };
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_FRAMECAPTURE_HPP
+#define PIXEL_FRAMECAPTURE_HPP
+
+#include "pch.hpp"
+
+namespace Pixel {
+  enum class CaptureFormat : uint8_t {
+    png      = 0,  // One numbered file per frame inside the output directory
+    rgb      = 1,  // Raw rgb24 frames appended to a single stream
+    yuv420   = 2,  // Raw I420 frames (BT.601, limited range) appended to a single stream
+    callback = 3,  // Bottom row first RGBA frames handed to CaptureSettings::callback
+  };
+
+  struct CaptureSettings {
+    CaptureFormat         format  = CaptureFormat::png;
+    std::filesystem::path output  = "capture";  // Directory for png, file or named pipe for raw formats
+    std::string           command = {};         // When set, raw frames go to this command's stdin instead of output
+    uint32_t              workers = 2;
+
+    // Runs on a worker thread, with a single worker frames arrive in capture order
+    std::function<void(uint64_t frame, const uint8_t* rgba, const glm::uvec2& size)> callback = {};
+
+    float fixed_timestep = 0.f;  // Application seconds per captured frame, 0 follows real time
+  };
+
+  // Reads frames back through a ring of persistently mapped pixel pack buffers guarded by fences. The readback of
+  // frame N is only collected after frame N + 2 has been submitted, so the CPU never waits on a transfer the GPU has
+  // not had time to finish. Collected frames are encoded by a pool of worker threads; raw streams are still written in
+  // frame order. When the workers fall behind, Capture blocks instead of dropping frames.
+  class FrameCapture {
+   public:
+    void Start(const CaptureSettings& settings, const glm::uvec2& size);
+    void Capture(GLuint framebuffer);
+    void Stop();
+
+    bool                   Active() const { return pActive; }
+    const CaptureSettings& Settings() const { return pSettings; }
+    const glm::uvec2&      Size() const { return pSize; }
+
+    uint64_t FramesCaptured() const { return pFrameIndex; }
+    uint64_t FramesWritten() const { return pFramesWritten; }
+
+   private:
+    struct Slot {
+      GLuint   buffer  = 0;
+      GLsync   fence   = nullptr;
+      uint8_t* mapping = nullptr;
+      uint64_t frame   = 0;
+    };
+
+    struct Job {
+      uint64_t frame  = 0;
+      uint32_t buffer = 0;
+    };
+
+    void pRetire(Slot& slot);
+    void pWorker();
+    void pWriteOrdered(uint64_t frame, const uint8_t* data, size_t size);
+
+   private:
+    static constexpr uint32_t pRingSize = 3;
+
+    CaptureSettings pSettings   = {};
+    glm::uvec2      pSize       = {};
+    size_t          pFrameBytes = 0;
+    bool            pActive     = false;
+    uint64_t        pFrameIndex = 0;
+
+    Slot pSlots[pRingSize] = {};
+
+    std::vector<std::vector<uint8_t>> pBuffers;
+    std::vector<uint32_t>             pFreeBuffers;
+    std::deque<Job>                   pJobs;
+    std::vector<std::thread>          pWorkers;
+    bool                              pStopping = false;
+
+    std::mutex              pMutex;
+    std::condition_variable pJobReady;
+    std::condition_variable pBufferFree;
+
+    std::mutex              pStreamMutex;
+    std::condition_variable pStreamTurn;
+    uint64_t                pNextWrite = 0;
+    FILE*                   pStream    = nullptr;
+
+    std::atomic<uint64_t> pFramesWritten {0};
+  };
+}
+
+#endif
@@ -0,0 +1,160 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_FRAMEPACKET_HPP
+#define PIXEL_FRAMEPACKET_HPP
+
+#include "pch.hpp"
+#include "Pixel/FrameCapture.hpp"
+#include "Pixel/GpuTimer.hpp"
+#include "Pixel/RenderBackend.hpp"
+
+namespace Pixel {
+  // One frame as the update thread produced it, for the render thread to draw: the Renderer's backend calls with
+  // copies of everything they point to, and a copy of the ImGui draw data. Packets are reused, so once they have
+  // grown to a typical frame recording into them no longer allocates, apart from the ImGui copy.
+  class FramePacket {
+   public:
+    FramePacket() = default;
+    ~FramePacket();
+
+    FramePacket(const FramePacket&)            = delete;
+    FramePacket& operator=(const FramePacket&) = delete;
+
+    void Reset();
+    void Replay(RenderBackend& backend) const;
+
+    void Upload(const BatchUpload& batch);
+    void Draw(const BatchDraw& draw);
+    void BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color);
+    void EndTarget(RenderTarget& target);
+    void BeginOverdraw(const glm::uvec2& size);
+    void EndOverdraw();
+
+    void        SetImGuiDrawData(const ImDrawData* draw_data);
+    ImDrawData* ImGuiDrawData() { return pImGuiData.Valid ? &pImGuiData : nullptr; }
+
+   public:
+    glm::uvec2 render_resolution = {};
+    bool       offscreen         = false;  // Whether the world pass draws into the world target
+    float      max_scale         = 1.f;    // The dynamic resolution scale the world target is sized for
+
+    // Capture requests taken by the update thread, for the render thread to act on when it draws this frame
+    bool            capture_start = false;
+    bool            capture_stop  = false;
+    CaptureSettings capture       = {};
+
+    // Filled in by the render thread once the packet is drawn, read back by the update thread when it reuses it
+    bool            drawn       = false;
+    float           render_time = 0.f;
+    float           work_time   = 0.f;  // Until the swap, which blocks on vsync
+    GpuTimings      gpu         = {};
+    GpuTimingWindow gpu_window  = {};
+
+   private:
+    enum class Command : uint8_t {
+      upload         = 0,
+      draw           = 1,
+      begin_target   = 2,
+      end_target     = 3,
+      begin_overdraw = 4,
+      end_overdraw   = 5,
+    };
+
+    // Offsets index into the packet's arrays, count is vertices for an upload and textures for a draw
+    struct Entry {
+      Command       command     = Command::upload;
+      bool          lines       = false;
+      bool          clear       = false;
+      uint32_t      first       = 0;
+      uint32_t      count       = 0;
+      uint32_t      first_index = 0;
+      uint32_t      index_count = 0;
+      uint32_t      matrix      = 0;  // View projection, followed by the transform
+      DebugView     debug_view  = DebugView::none;
+      glm::vec3     debug_color = {};
+      glm::vec4     clear_color = {};
+      glm::uvec2    size        = {};
+      RenderTarget* target      = nullptr;
+    };
+
+    void pReleaseImGui();
+
+   private:
+    std::vector<Entry>     pEntries;
+    std::vector<Vertex>    pVertices;
+    std::vector<uint32_t>  pIndices;
+    std::vector<glm::mat4> pMatrices;
+    std::vector<uint32_t>  pTextures;
+
+    ImDrawData               pImGuiData = {};
+    std::vector<ImDrawList*> pImGuiLists;
+  };
+
+  // Records into the bound packet in place of drawing, and passes calls straight on to the target backend while no
+  // packet is bound, such as during pOnLaunch. Init and Delete always go to the target.
+  class PacketBackend : public RenderBackend {
+   public:
+    void SetTarget(RenderBackend* target) { pTarget = target; }
+    void Bind(FramePacket* packet) { pPacket = packet; }
+
+    void Init() override { pTarget->Init(); }
+    void Delete() override { pTarget->Delete(); }
+
+    void Upload(const BatchUpload& batch) override;
+    void Draw(const BatchDraw& draw) override;
+
+    void BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) override;
+    void EndTarget(RenderTarget& target) override;
+
+    void BeginOverdraw(const glm::uvec2& size) override;
+    void EndOverdraw() override;
+
+   private:
+    RenderBackend* pTarget = nullptr;
+    FramePacket*   pPacket = nullptr;
+  };
+
+  // Packets cycle between the update thread, which fills free ones, and the render thread, which draws filled ones in
+  // order. Up to depth packets can be filled while another is being drawn, after which the update thread waits.
+  class FrameQueue {
+   public:
+    void Create(uint32_t depth);
+    void Release();
+
+    FramePacket* AcquireFree();    // nullptr once closed
+    void         Submit(FramePacket* packet);
+    FramePacket* AcquireFilled();  // nullptr once closed and drained
+    void         Recycle(FramePacket* packet);
+
+    // Wakes both sides, the render thread still gets every packet submitted before
+    void Close();
+    void Reopen();
+
+   private:
+    std::unique_ptr<FramePacket[]> pPackets;
+    std::deque<FramePacket*>       pFree;
+    std::deque<FramePacket*>       pFilled;
+    bool                           pClosed = false;
+
+    std::mutex              pMutex;
+    std::condition_variable pChanged;
+  };
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_GLBACKEND_HPP
+#define PIXEL_GLBACKEND_HPP
+
+#include "pch.hpp"
+#include "Pixel/PostProcess.hpp"
+#include "Pixel/RenderBackend.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Pixel/Shader.hpp"
+
+namespace Pixel {
+  // The OpenGL 4.5 backend Renderer uses unless told otherwise, one vertex array with fixed size buffers per primitive
+  // type, refilled with glBufferSubData on every upload
+  class GlBackend : public RenderBackend {
+   public:
+    void Init() override;
+    void Delete() override;
+
+    void Upload(const BatchUpload& batch) override;
+    void Draw(const BatchDraw& draw) override;
+
+    void BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) override;
+    void EndTarget(RenderTarget& target) override;
+
+    void BeginOverdraw(const glm::uvec2& size) override;
+    void EndOverdraw() override;
+
+   private:
+    struct Batch {
+      GLuint vertex_array  = 0;
+      GLuint vertex_buffer = 0;
+      GLuint index_buffer  = 0;
+    };
+
+    struct SavedTarget {
+      GLint framebuffer = 0;
+      GLint viewport[4] = {};
+    };
+
+    void pCreateBatch(Batch& batch);
+    void pDeleteBatch(Batch& batch);
+
+   private:
+    ShaderProgram pShader;
+    Batch         pTris  = {};
+    Batch         pLines = {};
+
+    GLint pViewProjectionLocation = -1;
+    GLint pTransformLocation      = -1;
+    GLint pDebugViewLocation      = -1;
+    GLint pDebugColorLocation     = -1;
+
+    SavedTarget pTargets[Renderer::pMaxTargetDepth] = {};
+    uint32_t    pTargetDepth                        = 0;
+
+    RenderTarget   pOverdrawTarget   = {};
+    FullscreenPass pOverdrawPass     = {};
+    SavedTarget    pOverdrawSaved    = {};
+    GLint          pOverdrawBlend[2] = {};
+  };
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_GPUTIMER_HPP
+#define PIXEL_GPUTIMER_HPP
+
+#include "pch.hpp"
+
+namespace Pixel {
+  enum class GpuPhase : uint8_t {
+    frame        = 0,
+    world        = 1,  // Clear and pOnRender, including the flushes below
+    tri_flush    = 2,
+    line_flush   = 3,
+    post_process = 4,  // Resolve, scaling and FXAA of the world pass
+    imgui        = 5,
+    count        = 6,
+  };
+
+  struct GpuTimings {
+    float phases[(size_t)GpuPhase::count] = {};  // In seconds, phases entered several times in a frame are summed
+
+    float operator[](GpuPhase phase) const { return phases[(size_t)phase]; }
+  };
+
+  struct GpuTimingWindow {
+    GpuTimings min = {};
+    GpuTimings avg = {};
+    GpuTimings max = {};
+  };
+
+  // Brackets frame phases with GL_TIMESTAMP query pairs, which unlike GL_TIME_ELAPSED may nest and interleave. Every
+  // frame owns a query pool that is read back pLatency frames later; when its last query is not available yet the
+  // frame goes unmeasured instead of stalling. Phases begun outside BeginFrame/EndFrame are ignored.
+  class GpuTimer {
+   public:
+    void Create();
+    void Release();
+
+    void BeginFrame();
+    void EndFrame();
+
+    void Begin(GpuPhase phase);
+    void End(GpuPhase phase);
+
+    const GpuTimings&      Last() const { return pLast; }
+    const GpuTimingWindow& Window() const { return pWindowStats; }
+    uint32_t               Dropped() const { return pDropped; }  // Query pairs that did not fit in a frame's pool
+
+   private:
+    void pCollect(uint32_t index);
+
+   private:
+    static constexpr uint32_t pLatency    = 3;
+    static constexpr uint32_t pMaxQueries = 512;
+    static constexpr uint32_t pWindow     = 120;
+
+    struct Frame {
+      GLuint   queries[pMaxQueries]    = {};
+      GpuPhase phases[pMaxQueries / 2] = {};
+      uint32_t count                   = 0;
+      uint32_t last                    = 0;  // The query issued last, which completes last
+      bool     pending                 = false;
+    };
+
+    std::unique_ptr<Frame[]> pFrames;
+    uint32_t                 pIndex     = 0;
+    bool                     pRecording = false;
+
+    int32_t pOpen[(size_t)GpuPhase::count] = {};
+
+    GpuTimings      pLast         = {};
+    GpuTimings      pHistory[pWindow];
+    uint32_t        pHistoryHead  = 0;
+    uint32_t        pHistoryCount = 0;
+    GpuTimingWindow pWindowStats  = {};
+    uint32_t        pDropped      = 0;
+  };
+}
+
+#endif
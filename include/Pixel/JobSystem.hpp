@@ -0,0 +1,98 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_JOBSYSTEM_HPP
+#define PIXEL_JOBSYSTEM_HPP
+
+#include "pch.hpp"
+
+namespace Pixel {
+  using Job = std::function<void()>;
+
+  // Jobs run against a counter are outstanding on it until they finish. A counter can also gate other jobs, which
+  // are only queued once it drains, so chains of counters form a job graph.
+  class JobCounter {
+   public:
+    bool     Done() const { return pPending.load(std::memory_order_acquire) == 0; }
+    uint32_t Pending() const { return pPending.load(std::memory_order_acquire); }
+
+   private:
+    friend class JobSystem;
+
+    struct Continuation {
+      Job         job;
+      JobCounter* signal = nullptr;
+    };
+
+    std::atomic<uint32_t>     pPending {0};
+    mutable std::mutex        pMutex;
+    std::vector<Continuation> pContinuations;
+  };
+
+  // Every worker owns a deque it pushes and pops at the back, idle workers steal from the front of the others.
+  // Threads that are not workers share one extra deque. Waiting never blocks while there is work anywhere, the waiting
+  // thread runs jobs itself until its counter drains, so jobs may run and wait on further jobs freely.
+  class JobSystem {
+   public:
+    ~JobSystem();
+
+    // 0 workers leaves one hardware thread for the caller, which works too whenever it waits
+    void Create(uint32_t workers = 0);
+    void Release();
+
+    // Shared by the engine and the application, created on first use with the default worker count
+    static JobSystem& Default();
+
+    void Run(Job job, JobCounter* signal = nullptr);
+    void Run(Job job, JobCounter* signal, JobCounter& after);  // Queued once after drains
+    void Wait(const JobCounter& counter);
+
+    // Splits [0, count) into ranges of at most grain items and returns once body has run on all of them
+    void ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& body);
+
+    uint32_t Workers() const { return pWorkerCount; }
+
+   private:
+    struct Task {
+      Job         job;
+      JobCounter* signal = nullptr;
+    };
+
+    struct alignas(64) Queue {
+      std::mutex       mutex;
+      std::deque<Task> tasks;
+    };
+
+    void pPush(Task task);
+    bool pFind(Task& task);
+    void pExecute(Task& task);
+    void pWorker(uint32_t worker);
+
+   private:
+    uint32_t                 pWorkerCount = 0;
+    std::unique_ptr<Queue[]> pQueues;  // One per worker plus the shared one at the end
+    std::vector<std::thread> pWorkers;
+
+    std::atomic<uint32_t>   pQueued {0};
+    std::atomic<bool>       pStopping {false};
+    std::mutex              pSleepMutex;
+    std::condition_variable pWake;
+  };
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_NULLBACKEND_HPP
+#define PIXEL_NULLBACKEND_HPP
+
+#include "pch.hpp"
+#include "Pixel/RenderBackend.hpp"
+
+namespace Pixel {
+  struct NullBackendCounters {
+    uint64_t uploads         = 0;
+    uint64_t draws           = 0;
+    uint64_t vertices        = 0;  // Uploaded, the same vertex uploaded twice counts twice
+    uint64_t indices         = 0;  // Drawn
+    uint64_t bytes           = 0;  // Vertex and index data uploaded
+    uint64_t texture_binds   = 0;
+    uint64_t targets         = 0;
+    uint64_t overdraw_passes = 0;
+    uint64_t checksum        = 0;  // Hash of every upload and draw, equal across runs that submit the same frames
+  };
+
+  // Records what Renderer submits without touching a GPU, so batching and geometry generation can be measured and
+  // checked on machines with no graphics driver. Renderer::white_texture stays unloaded and has id 0.
+  class NullBackend : public RenderBackend {
+   public:
+    void Init() override;
+    void Delete() override;
+
+    void Upload(const BatchUpload& batch) override;
+    void Draw(const BatchDraw& draw) override;
+
+    void BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) override;
+    void EndTarget(RenderTarget& target) override;
+
+    void BeginOverdraw(const glm::uvec2& size) override;
+    void EndOverdraw() override;
+
+    const NullBackendCounters& Counters() const;
+    void                       Reset();
+
+   private:
+    void pHash(const void* bytes, size_t size);
+
+   private:
+    NullBackendCounters pCounters = {};
+  };
+}
+
+#endif
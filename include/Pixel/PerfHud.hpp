@@ -0,0 +1,58 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_PERFHUD_HPP
+#define PIXEL_PERFHUD_HPP
+
+#include "pch.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Util/Metrics.hpp"
+#include "Util/Profiler.hpp"
+
+namespace Pixel {
+  // ImGui overlay with the frame time graph, metric percentiles, GPU phase timings, texture memory, batch flushes
+  // by reason and call site, and the slowest profiler zones of the last frame. The graph reads straight from the
+  // metric ring; everything else is refreshed a few times per second into fixed arrays, so drawing never allocates.
+  class PerfHud {
+   public:
+    void Draw(const MetricsRegistry& metrics, uint32_t frame_time_metric);
+
+   private:
+    void pRefresh(const MetricsRegistry& metrics);
+
+   private:
+    static constexpr uint32_t pMaxMetrics      = 64;
+    static constexpr uint32_t pMaxZones        = 8;
+    static constexpr uint32_t pMaxFlushSites   = 8;
+    static constexpr float    pRefreshInterval = .25f;
+
+    MetricSummary pSummaries[pMaxMetrics] = {};
+    uint32_t      pSummaryCount           = 0;
+
+    ProfileZoneTotal pZones[pMaxZones] = {};
+    uint32_t         pZoneCount        = 0;
+
+    FlushLog  pFlushLog                   = {};
+    FlushSite pFlushSites[pMaxFlushSites] = {};
+    uint32_t  pFlushSiteCount             = 0;
+
+    std::chrono::steady_clock::time_point pLastRefresh = {};
+  };
+}
+
+#endif
@@ -22,13 +22,34 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "pch.hpp"
 
 #include "Pixel/Application.hpp"
+#include "Pixel/AssetPack.hpp"
+#include "Pixel/CanvasTexture.hpp"
+#include "Pixel/CommandRecording.hpp"
+#include "Pixel/DynamicResolution.hpp"
+#include "Pixel/FrameCapture.hpp"
+#include "Pixel/GlBackend.hpp"
+#include "Pixel/GpuTimer.hpp"
+#include "Pixel/JobSystem.hpp"
+#include "Pixel/NullBackend.hpp"
 #include "Pixel/OrthographicCamera.hpp"
+#include "Pixel/PerfHud.hpp"
+#include "Pixel/PostProcess.hpp"
+#include "Pixel/RenderBackend.hpp"
+#include "Pixel/RenderTarget.hpp"
 #include "Pixel/Renderer.hpp"
 #include "Pixel/Shader.hpp"
+#include "Pixel/SoftwareBackend.hpp"
 #include "Pixel/Texture.hpp"
+#include "Pixel/TextureCompression.hpp"
+#include "Pixel/TextureMips.hpp"
 
 #include "Util/Logger.hpp"
+#include "Util/Metrics.hpp"
 #include "Util/Misc.hpp"
+#include "Util/PngWriter.hpp"
+#include "Util/Profiler.hpp"
+#include "Util/SpscQueue.hpp"
+#include "Util/TripleBuffer.hpp"
 #include "Util/UUID.hpp"
 
 #endif
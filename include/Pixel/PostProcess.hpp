@@ -0,0 +1,117 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_POSTPROCESS_HPP
+#define PIXEL_POSTPROCESS_HPP
+
+#include "pch.hpp"
+#include "Pixel/Shader.hpp"
+#include "Pixel/Texture.hpp"
+
+namespace Pixel {
+  // Draws a single full-viewport triangle that samples `source`. Only the bottom-left `uv_scale` fraction of the source
+  // is read, so a target rendered at a reduced viewport can be filtered and upscaled in the same pass.
+  class FullscreenPass {
+   public:
+    void Create(std::string_view fragment_code);
+    void Release();
+
+    void Draw(const Texture& source, const glm::uvec2& source_size, const glm::vec2& uv_scale = {1.f, 1.f});
+
+    ShaderProgram& getShader() { return pShader; }
+
+   private:
+    ShaderProgram pShader;
+    GLuint        pVertexArray = 0;
+
+    GLint pSourceLocation  = -1;
+    GLint pTexelLocation   = -1;
+    GLint pUvScaleLocation = -1;
+  };
+
+  const std::string fullscreen_vertex_shader_code =
+      "#version 460 core\n"
+      "out vec2 our_uv;\n"
+      "void main() {\n"
+      "vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+      "our_uv        = position;\n"
+      "gl_Position   = vec4(position * 2.0f - 1.0f, 0.0f, 1.0f);\n"
+      "}\n";
+
+  const std::string blit_fragment_shader_code =
+      "#version 460 core\n"
+      "in vec2 our_uv;\n"
+      "out vec4 color;\n"
+      "uniform sampler2D u_source;\n"
+      "uniform vec2 u_uv_scale;\n"
+      "void main() {\n"
+      "color = texture(u_source, our_uv * u_uv_scale);\n"
+      "}\n";
+
+  // Maps the overdraw count in the red channel to black, blue, cyan, green, yellow and red at 0, 1, 2, 4, 8 and 16+
+  // layers, so each step up the ramp is a doubling of the shading work
+  const std::string overdraw_fragment_shader_code =
+      "#version 460 core\n"
+      "in vec2 our_uv;\n"
+      "out vec4 color;\n"
+      "uniform sampler2D u_source;\n"
+      "uniform vec2 u_uv_scale;\n"
+      "const vec3 ramp[6] = vec3[](vec3(0.0f), vec3(0.0f, 0.1f, 0.7f), vec3(0.0f, 0.7f, 0.9f),\n"
+      "                            vec3(0.1f, 0.9f, 0.2f), vec3(1.0f, 0.9f, 0.0f), vec3(1.0f, 0.1f, 0.1f));\n"
+      "void main() {\n"
+      "float layers = texture(u_source, our_uv * u_uv_scale).r;\n"
+      "float t      = clamp(layers < 1.0f ? layers : 1.0f + log2(layers), 0.0f, 5.0f);\n"
+      "int   i      = min(int(t), 4);\n"
+      "color = vec4(mix(ramp[i], ramp[i + 1], t - float(i)), 1.0f);\n"
+      "}\n";
+
+  // FXAA 3.11 style edge search reduced to a single directional blur along the local luma gradient
+  const std::string fxaa_fragment_shader_code =
+      "#version 460 core\n"
+      "in vec2 our_uv;\n"
+      "out vec4 color;\n"
+      "uniform sampler2D u_source;\n"
+      "uniform vec2 u_texel;\n"
+      "uniform vec2 u_uv_scale;\n"
+      "const float span_max   = 8.0f;\n"
+      "const float reduce_mul = 1.0f / 8.0f;\n"
+      "const float reduce_min = 1.0f / 128.0f;\n"
+      "const vec3  luma       = vec3(0.299f, 0.587f, 0.114f);\n"
+      "vec4 fetch(vec2 uv) { return texture(u_source, clamp(uv, u_texel * 0.5f, u_uv_scale - u_texel * 0.5f)); }\n"
+      "void main() {\n"
+      "vec2  uv     = our_uv * u_uv_scale;\n"
+      "float luma_nw = dot(fetch(uv + vec2(-1.0f, -1.0f) * u_texel).rgb, luma);\n"
+      "float luma_ne = dot(fetch(uv + vec2(1.0f, -1.0f) * u_texel).rgb, luma);\n"
+      "float luma_sw = dot(fetch(uv + vec2(-1.0f, 1.0f) * u_texel).rgb, luma);\n"
+      "float luma_se = dot(fetch(uv + vec2(1.0f, 1.0f) * u_texel).rgb, luma);\n"
+      "vec4  center  = fetch(uv);\n"
+      "float luma_m  = dot(center.rgb, luma);\n"
+      "float luma_min = min(luma_m, min(min(luma_nw, luma_ne), min(luma_sw, luma_se)));\n"
+      "float luma_max = max(luma_m, max(max(luma_nw, luma_ne), max(luma_sw, luma_se)));\n"
+      "vec2 dir = vec2(-((luma_nw + luma_ne) - (luma_sw + luma_se)), (luma_nw + luma_sw) - (luma_ne + luma_se));\n"
+      "float reduce = max((luma_nw + luma_ne + luma_sw + luma_se) * 0.25f * reduce_mul, reduce_min);\n"
+      "float scale  = 1.0f / (min(abs(dir.x), abs(dir.y)) + reduce);\n"
+      "dir = clamp(dir * scale, vec2(-span_max), vec2(span_max)) * u_texel;\n"
+      "vec4 a = 0.5f * (fetch(uv + dir * (1.0f / 3.0f - 0.5f)) + fetch(uv + dir * (2.0f / 3.0f - 0.5f)));\n"
+      "vec4 b = a * 0.5f + 0.25f * (fetch(uv + dir * -0.5f) + fetch(uv + dir * 0.5f));\n"
+      "float luma_b = dot(b.rgb, luma);\n"
+      "color = (luma_b < luma_min || luma_b > luma_max) ? a : b;\n"
+      "}\n";
+}
+
+#endif
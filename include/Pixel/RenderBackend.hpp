@@ -0,0 +1,84 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_RENDERBACKEND_HPP
+#define PIXEL_RENDERBACKEND_HPP
+
+#include "pch.hpp"
+#include "Pixel/RenderTarget.hpp"
+
+namespace Pixel {
+  struct Vertex {
+    glm::vec3 position {};
+    glm::vec4 color {};
+    glm::vec2 tex_coord {};
+    float     tex_id = 0.f;
+  };
+
+  // Values are shared with the fragment shader's u_debug_view
+  enum class DebugView : uint8_t {
+    none      = 0,
+    overdraw  = 1,  // Heatmap of how many times each pixel was shaded
+    batches   = 2,  // Every draw call tinted with its own color
+    wireframe = 3,  // Triangle edges only, shows how finely shapes are tessellated
+  };
+
+  // A finished batch, handed over by Renderer::EndBatch or when a batch fills up
+  struct BatchUpload {
+    bool             lines           = false;
+    const Vertex*    vertices        = nullptr;
+    uint32_t         vertex_count    = 0;
+    const uint32_t*  indices         = nullptr;
+    uint32_t         index_count     = 0;
+    const glm::mat4* view_projection = nullptr;
+    const glm::mat4* transform       = nullptr;
+  };
+
+  // Draws the batch last uploaded for the same primitive type, with textures bound to units in slot order
+  struct BatchDraw {
+    bool            lines         = false;
+    uint32_t        index_count   = 0;
+    const uint32_t* textures      = nullptr;
+    uint32_t        texture_count = 0;
+    DebugView       debug_view    = DebugView::none;
+    glm::vec3       debug_color   = {};
+  };
+
+  // Everything Renderer submits goes through this interface, so its whole CPU path can run against something other
+  // than OpenGL. Calls come from the thread that owns the renderer, in submission order.
+  class RenderBackend {
+   public:
+    virtual ~RenderBackend() = default;
+
+    virtual void Init()   = 0;
+    virtual void Delete() = 0;
+
+    virtual void Upload(const BatchUpload& batch) = 0;
+    virtual void Draw(const BatchDraw& draw)      = 0;
+
+    // Nested like Renderer::BeginTarget and EndTarget, EndTarget resolves the target and restores the previous one
+    virtual void BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) = 0;
+    virtual void EndTarget(RenderTarget& target)                                            = 0;
+
+    // Redirects drawing into a layer counter until EndOverdraw, which composites the heatmap into the current target
+    virtual void BeginOverdraw(const glm::uvec2& size) = 0;
+    virtual void EndOverdraw()                         = 0;
+  };
+}
+
+#endif
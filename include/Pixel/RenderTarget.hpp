@@ -0,0 +1,62 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_RENDERTARGET_HPP
+#define PIXEL_RENDERTARGET_HPP
+
+#include "pch.hpp"
+#include "Pixel/Texture.hpp"
+
+namespace Pixel {
+  // A framebuffer with a single color texture. Being a Texture, a target can be composited with Renderer::DrawQuad;
+  // Valid() stays true from the Renderer::EndTarget that filled it until Invalidate() or a resize, which lets rarely
+  // changing layers be redrawn only when their content actually changes. Multisampled targets draw into a renderbuffer
+  // and Resolve() into the texture, which Renderer::EndTarget does automatically.
+  class RenderTarget : public Texture {
+   public:
+    void Create(const glm::uvec2& size, GLenum internal_format = GL_RGBA8, uint32_t samples = 0);
+    void Resize(const glm::uvec2& size);
+    void Release();
+
+    void Resolve();
+    void Resolve(const glm::uvec2& region);
+
+    const glm::uvec2& Size() const { return pSize; }
+    GLenum            InternalFormat() const { return pInternalFormat; }
+    uint32_t          Samples() const { return pSamples; }
+
+    GLuint getFramebuffer() const { return pSamples ? pMultisampleFramebuffer : pFramebuffer; }
+    GLuint getTextureFramebuffer() const { return pFramebuffer; }
+
+    void Invalidate() { pValid = false; }
+    bool Valid() const { return pValid; }
+
+   private:
+    friend class Renderer;
+
+    glm::uvec2 pSize                    = {};
+    GLenum     pInternalFormat          = GL_RGBA8;
+    uint32_t   pSamples                 = 0;
+    GLuint     pFramebuffer             = 0;
+    GLuint     pMultisampleFramebuffer  = 0;
+    GLuint     pMultisampleRenderbuffer = 0;
+    bool       pValid                   = false;
+  };
+}
+
+#endif
@@ -20,77 +20,137 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define PIXEL_RENDERER_HPP
 
 #include "pch.hpp"
+#include "Pixel/CommandRecording.hpp"
+#include "Pixel/GpuTimer.hpp"
 #include "Pixel/OrthographicCamera.hpp"
+#include "Pixel/RenderBackend.hpp"
+#include "Pixel/RenderTarget.hpp"
 #include "Pixel/Texture.hpp"
 
 namespace Pixel {
-  struct Vertex {
-    glm::vec3 position {};
-    glm::vec4 color {};
-    glm::vec2 tex_coord {};
-    float     tex_id = 0.f;
+  enum class FlushReason : uint8_t {
+    index_capacity  = 0,  // The batch ran out of index space
+    vertex_capacity = 1,  // The batch ran out of vertex space
+    texture_slots   = 2,  // A quad needed a texture while every slot was taken
+    target          = 3,  // BeginTarget or EndTarget switched framebuffers
+    manual          = 4,  // FlushBatch
+    count,
+  };
+
+  const char* FlushReasonName(FlushReason reason);
+
+  struct FlushEvent {
+    FlushReason          reason      = FlushReason::manual;
+    bool                 lines       = false;  // Whether the line batch was flushed rather than the triangle one
+    uint32_t             index_count = 0;
+    std::source_location location    = {};  // Draw call that triggered the flush
+  };
+
+  struct FlushSite {
+    FlushReason          reason   = FlushReason::manual;
+    bool                 lines    = false;
+    uint32_t             count    = 0;
+    std::source_location location = {};
+  };
+
+  struct FlushLog {
+    static constexpr uint32_t pMaxEvents = 256;
+
+    uint32_t   counts[(size_t)FlushReason::count] = {};
+    uint32_t   total                              = 0;
+    uint32_t   dropped                            = 0;  // Events past pMaxEvents, still part of counts and total
+    FlushEvent events[pMaxEvents]                 = {};
   };
 
   class Renderer {
    public:
+    // Must come before Init. The backend stays owned by the caller, nullptr selects the built-in OpenGL one.
+    static void           SetBackend(RenderBackend* backend);
+    static RenderBackend& Backend();
+
+    // Every call that draws or changes drawing state is handed to the recorder while it is active, nullptr detaches
+    static void SetRecorder(CommandRecorder* recorder);
+
     static void Init();
     static void Delete();
 
+    // Every drawing function takes the location of its caller so flushes can be traced back to the draw that
+    // caused them. Wrappers around the renderer can forward their own caller's location instead.
+    using Location = std::source_location;
+
     static void BeginBatch();
     static void EndBatch();
-    static void FlushBatch();
+    static void FlushBatch(const Location& location = Location::current());
+
+    static void BeginTarget(RenderTarget&    target,
+                            bool             clear       = true,
+                            const glm::vec4& clear_color = {0.f, 0.f, 0.f, 0.f},
+                            const Location&  location    = Location::current());
+    static void EndTarget(const Location& location = Location::current());
 
     static void DrawQuad(const glm::vec2& position,
                          const glm::vec2& size,
-                         const glm::vec4& color   = {1.f, 1.f, 1.f, 1.f},
-                         const Texture&   texture = white_texture);
+                         const glm::vec4& color    = {1.f, 1.f, 1.f, 1.f},
+                         const Texture&   texture  = white_texture,
+                         const Location&  location = Location::current());
 
     static void DrawTri(const glm::vec2& v1,
                         const glm::vec2& v2,
                         const glm::vec2& v3,
-                        const glm::vec4& color = {1.f, 1.f, 1.f, 1.f});
+                        const glm::vec4& color    = {1.f, 1.f, 1.f, 1.f},
+                        const Location&  location = Location::current());
 
     static void DrawCircle(const glm::vec2& position,
                            float            radius,
                            uint32_t         segments,
-                           const glm::vec4& color = {1.f, 1.f, 1.f, 1.f});
+                           const glm::vec4& color    = {1.f, 1.f, 1.f, 1.f},
+                           const Location&  location = Location::current());
 
-    static void DrawLine(const glm::vec2& pos1, const glm::vec2& pos2, const glm::vec4& color = {1.f, 1.f, 1.f, 1.f});
+    static void DrawLine(const glm::vec2& pos1,
+                         const glm::vec2& pos2,
+                         const glm::vec4& color    = {1.f, 1.f, 1.f, 1.f},
+                         const Location&  location = Location::current());
 
     static void DrawLine(const glm::vec2& pos1,
                          const glm::vec2& pos2,
                          float            width,
-                         const glm::vec4& color = {1.f, 1.f, 1.f, 1.f});
+                         const glm::vec4& color    = {1.f, 1.f, 1.f, 1.f},
+                         const Location&  location = Location::current());
 
     static void OutlineQuad(const glm::vec2& position,
                             const glm::vec2& size,
-                            const glm::vec4& color = {1.f, 1.f, 1.f, 1.f});
+                            const glm::vec4& color    = {1.f, 1.f, 1.f, 1.f},
+                            const Location&  location = Location::current());
 
     static void OutlineTri(const glm::vec2& v1,
                            const glm::vec2& v2,
                            const glm::vec2& v3,
                            float            width,
-                           const glm::vec4& color = {1.f, 1.f, 1.f, 1.f});
+                           const glm::vec4& color    = {1.f, 1.f, 1.f, 1.f},
+                           const Location&  location = Location::current());
 
     static void BorderTri(const glm::vec2& v1,
                           const glm::vec2& v2,
                           const glm::vec2& v3,
                           float            width,
                           const glm::vec4& inner_color,
-                          const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f});
+                          const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f},
+                          const Location&  location     = Location::current());
 
     static void OutlineCircle(const glm::vec2& position,
                               float            radius,
                               uint32_t         segments,
                               float            width,
-                              const glm::vec4& color = {1.f, 1.f, 1.f, 1.f});
+                              const glm::vec4& color    = {1.f, 1.f, 1.f, 1.f},
+                              const Location&  location = Location::current());
 
     static void BorderCircle(const glm::vec2& position,
                              float            radius,
                              uint32_t         segments,
                              float            width,
                              const glm::vec4& inner_color,
-                             const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f});
+                             const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f},
+                             const Location&  location     = Location::current());
 
     static void BorderSemicircle(const glm::vec2& position,
                                  float            radius,
@@ -99,7 +159,8 @@ namespace Pixel {
                                  uint32_t         segments,
                                  float            width,
                                  const glm::vec4& inner_color,
-                                 const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f});
+                                 const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f},
+                                 const Location&  location     = Location::current());
 
     static void BorderSemicircleCustomCenterInside(const glm::vec2& position,
                                                    const glm::vec2& center,
@@ -109,7 +170,8 @@ namespace Pixel {
                                                    uint32_t         segments,
                                                    float            width,
                                                    const glm::vec4& inner_color,
-                                                   const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f});
+                                                   const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f},
+                                                   const Location&  location     = Location::current());
 
     static void BorderSemicircleCustomCenterOutside(const glm::vec2& position,
                                                     const glm::vec2& center,
@@ -119,12 +181,17 @@ namespace Pixel {
                                                     uint32_t         segments,
                                                     float            width,
                                                     const glm::vec4& inner_color,
-                                                    const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f});
+                                                    const glm::vec4& outter_color = {1.f, 1.f, 1.f, 1.f},
+                                                    const Location&  location     = Location::current());
 
     static void SetViewProjection(const glm::mat4& view_projection);
     static void SetTransform(const glm::vec3& transform);
     static void UseCamera(const OrthographicCamera& camera);
 
+    // While set, replaces whatever view projection the application sets, used to render sub-regions of a frame
+    static void SetViewProjectionOverride(const glm::mat4& view_projection);
+    static void ClearViewProjectionOverride();
+
     struct Stats {
       uint32_t quads_drawn    = 0;
       uint32_t quads_outlined = 0;
@@ -149,18 +216,42 @@ namespace Pixel {
 
       uint32_t line_vertex_count = 0;
       uint32_t line_index_count  = 0;
+
+      // Filled from gpu_timer, a few frames behind the counters above and not cleared by ResetStats
+      GpuTimings      gpu        = {};
+      GpuTimingWindow gpu_window = {};
     };
 
     static void         ResetStats();
     static const Stats& GetStats();
 
+    // Once called, GetStats reports the GPU timings last published here instead of reading gpu_timer, for when the
+    // timer is driven from another thread than the one drawing
+    static void PublishGpuTimings(const GpuTimings& last, const GpuTimingWindow& window);
+
+    // Takes effect from the next flush. The overdraw view renders into its own target between BeginDebugView and
+    // EndDebugView, which the application places around the world pass, and resolves it through a color ramp.
+    static void      SetDebugView(DebugView view);
+    static DebugView GetDebugView();
+    static void      BeginDebugView(const glm::uvec2& size);
+    static void      EndDebugView(const Location& location = Location::current());
+
+    // Flushes are logged per frame. NewFrame closes the log of the frame that just ended, which stays queryable
+    // while the next one fills up.
+    static void            NewFrame();
+    static const FlushLog& LastFrameFlushes();
+    static uint32_t        LastFrameFlushSites(FlushSite* sites, uint32_t max);  // Most frequent first
+    static void            DumpFlushes(std::ostream& out);
+
    public:
     static constexpr uint32_t pMaxVertexCount = 20000;
     static constexpr uint32_t pMaxIndexCount  = 30000;
     static constexpr uint32_t pMaxTextures    = 8;  // TODO: query current device being used
+    static constexpr uint32_t pMaxTargetDepth = 8;
 
    public:
-    static Texture white_texture;
+    static Texture  white_texture;
+    static GpuTimer gpu_timer;
   };
 
   const std::string simple_vertex_shader_code =
@@ -188,9 +279,14 @@ namespace Pixel {
       "in float our_tex_index;\n"
       "out vec4 color;\n"
       "uniform sampler2D u_textures[8];\n"
+      "uniform int u_debug_view;\n"
+      "uniform vec3 u_debug_color;\n"
       "void main() {\n"
       "int index = int(our_tex_index);\n"
       "color = texture(u_textures[index], our_tex_coord) * our_color;\n"
+      "if (u_debug_view == 1) color = vec4(1.0f);\n"
+      "if (u_debug_view == 2) color = vec4(mix(color.rgb, u_debug_color, 0.75f), max(color.a, 0.5f));\n"
+      "if (u_debug_view == 3) color = vec4(our_color.rgb, 1.0f);\n"
       "}\n";
 }
 
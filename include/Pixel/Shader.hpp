@@ -26,14 +26,16 @@ namespace Pixel {
    public:
     ShaderProgram();
 
-    void LoadFromInlineCode(const std::string& vertex_code, const std::string& fragment_code);
+    void LoadFromInlineCode(std::string_view vertex_code, std::string_view fragment_code);
     void LoadFromFile(const std::string& vertex_path, const std::string& fragment_path);
 
+    void Release();
+
     GLuint getProgram();
     void   Use();
 
    private:
-    GLuint pProgram;
+    GLuint pProgram = 0;
   };
 }
 
@@ -0,0 +1,139 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_SOFTWAREBACKEND_HPP
+#define PIXEL_SOFTWAREBACKEND_HPP
+
+#include "pch.hpp"
+#include "Pixel/RenderBackend.hpp"
+#include "Pixel/Texture.hpp"
+#include "Pixel/TextureMips.hpp"
+
+namespace Pixel {
+  // Rasterizes on the CPU into RGBA8 surfaces, bottom row first like glReadPixels. Draws only transform and bin their
+  // primitives into screen tiles; the tiles are shaded in parallel when the results are needed, by Finish, Pixels, a
+  // target switch or an overdraw pass. Shading follows simple_fragment_shader_code with the same alpha blending the
+  // application sets up, and textures are sampled bilinearly from their base level with clamped edges.
+  class SoftwareBackend : public RenderBackend {
+   public:
+    // Must come before Renderer::Init, 0 threads uses every hardware thread
+    void Create(const glm::uvec2& size, uint32_t threads = 0);
+    void Resize(const glm::uvec2& size);
+
+    void Init() override;
+    void Delete() override;
+
+    void Upload(const BatchUpload& batch) override;
+    void Draw(const BatchDraw& draw) override;
+
+    void BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) override;
+    void EndTarget(RenderTarget& target) override;
+
+    void BeginOverdraw(const glm::uvec2& size) override;
+    void EndOverdraw() override;
+
+    void           Clear(const glm::vec4& color);  // The default framebuffer, stands in for glClear
+    void           Finish();
+    const uint8_t* Pixels();  // Finishes first
+
+    const glm::uvec2& Size() const { return pFramebuffer.size; }
+    uint32_t          Threads() const { return pThreadCount; }
+
+    // Texture ids come from OpenGL, so without a context the textures to draw with are made here. Release them with
+    // ReleaseTexture, never Texture::Release. SetTexture gives an existing texture the pixels to sample instead.
+    Texture CreateTexture(TextureImage image);
+    void    SetTexture(const Texture& texture, TextureImage image);
+    void    ReleaseTexture(Texture& texture);
+
+   private:
+    struct Surface {
+      glm::uvec2           size = {};
+      std::vector<uint8_t> color;
+    };
+
+    struct ShadedVertex {
+      glm::vec2 position {};  // Window coordinates
+      glm::vec4 color {};
+      glm::vec2 tex_coord {};
+    };
+
+    struct Primitive {
+      ShadedVertex        vertices[3] = {};
+      bool                line        = false;
+      const TextureImage* texture     = nullptr;  // nullptr samples white
+      DebugView           debug_view  = DebugView::none;
+      glm::vec3           debug_color = {};
+    };
+
+    struct alignas(64) TileRange {
+      std::atomic<uint32_t> next {0};
+      uint32_t              end = 0;
+    };
+
+    void pBin(const Primitive& primitive, const glm::vec2& min, const glm::vec2& max);
+    void pResizeTiles();
+    void pRasterizeTiles(uint32_t worker);
+    void pRasterizeTile(uint32_t tile);
+    void pRasterizeTriangle(const Primitive& primitive, const glm::ivec4& bounds);
+    void pRasterizeLine(const Primitive& primitive, const glm::ivec4& bounds);
+    void pShade(const Primitive& primitive, int32_t x, int32_t y, const glm::vec4& color, const glm::vec2& tex_coord);
+    void pWorker(uint32_t worker);
+
+   private:
+    static constexpr uint32_t pTileSize      = 64;
+    static constexpr uint32_t pMaxPrimitives = 1 << 20;  // Pending primitives before Draw finishes on its own
+
+    Surface  pFramebuffer = {};
+    Surface* pSurface     = &pFramebuffer;
+
+    std::unordered_map<const RenderTarget*, Surface> pTargets;
+    std::vector<Surface*>                            pTargetStack;
+
+    // Layer counts for the surface the overdraw pass began on, drawn instead of its colors. Targets begun during the
+    // pass shade normally, like they do on the GL backend.
+    std::vector<uint16_t> pOverdraw;
+    Surface*              pOverdrawSurface = nullptr;
+
+    std::unordered_map<GLuint, TextureImage> pTextures;
+    GLuint                                   pNextTextureId = 1u << 31;  // Far above any name a driver hands out
+
+    // Per batch type, what the last Upload left for Draw
+    struct {
+      const Vertex*   vertices = nullptr;
+      const uint32_t* indices  = nullptr;
+      glm::mat4       matrix   = glm::mat4(1.f);
+    } pUploads[2];
+
+    std::vector<Primitive>             pPrimitives;
+    std::vector<std::vector<uint32_t>> pBins;  // Primitive indices per tile, in submission order
+    glm::uvec2                         pTileCount = {};
+    std::vector<uint32_t>              pActiveTiles;
+    std::unique_ptr<TileRange[]>       pRanges;
+
+    uint32_t                 pThreadCount = 0;
+    std::vector<std::thread> pWorkers;
+    std::mutex               pMutex;
+    std::condition_variable  pWorkReady;
+    std::condition_variable  pWorkDone;
+    uint64_t                 pGeneration = 0;
+    uint32_t                 pBusy       = 0;
+    bool                     pStopping   = false;
+  };
+}
+
+#endif
@@ -22,18 +22,59 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "pch.hpp"
 
 namespace Pixel {
+  enum class TextureFormat : uint32_t {
+    rgba8 = 0,
+    bc1   = 1,
+    bc3   = 2,
+    bc7   = 3,
+  };
+
+  enum class MipFilter : uint32_t {
+    none   = 0,
+    gpu    = 1,
+    box    = 2,
+    kaiser = 3,
+  };
+
+  struct TextureOptions {
+    MipFilter     mips   = MipFilter::none;
+    TextureFormat format = TextureFormat::rgba8;
+  };
+
+  struct TextureLevel {
+    const void* data = nullptr;
+    uint32_t    size = 0;
+  };
+
+  uint64_t   TextureLevelSize(TextureFormat format, const glm::uvec2& size);
+  glm::uvec2 TextureLevelDimensions(const glm::uvec2& size, uint32_t level);
+
   class Texture {
    public:
-    void Load(const std::string& filepath);
+    void Load(const std::string& filepath, const TextureOptions& options = {});
     void Load(const glm::vec4& color);
+    void Load(const glm::uvec2& size, TextureFormat format, const TextureLevel* levels, uint32_t level_count);
 
     void Release();
 
     bool   Loaded() const { return pId == 0; }
     GLuint getId() const;
 
+    uint64_t        MemoryBytes() const { return pMemoryBytes; }
+    static uint64_t AllocatedBytes() { return pAllocatedBytes; }  // Across every live texture and render target
+
+   protected:
+    void pCreate(const glm::uvec2& size, TextureFormat format, uint32_t level_count);
+    void pTrackMemory(uint64_t bytes);
+
+   protected:
+    GLuint   pId          = 0;
+    uint64_t pMemoryBytes = 0;
+
+    static std::atomic<uint64_t> pAllocatedBytes;
+
    private:
-    GLuint pId = 0;
+    friend class SoftwareBackend;
   };
 }
 
@@ -0,0 +1,36 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_TEXTURECOMPRESSION_HPP
+#define PIXEL_TEXTURECOMPRESSION_HPP
+
+#include "pch.hpp"
+#include "Pixel/Texture.hpp"
+#include "Pixel/TextureMips.hpp"
+
+namespace Pixel {
+  // Block encoders favour speed over quality: endpoints come from the block bounding box and every texel picks the
+  // nearest palette entry. BC7 is always emitted as mode 6 (single subset, RGBA endpoints with p-bits).
+  void EncodeBC1Block(const uint8_t (&texels)[16][4], uint8_t* block);
+  void EncodeBC3Block(const uint8_t (&texels)[16][4], uint8_t* block);
+  void EncodeBC7Block(const uint8_t (&texels)[16][4], uint8_t* block);
+
+  std::vector<uint8_t> CompressTexture(const TextureImage& image, TextureFormat format);
+}
+
+#endif
@@ -0,0 +1,38 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_TEXTUREMIPS_HPP
+#define PIXEL_TEXTUREMIPS_HPP
+
+#include "pch.hpp"
+#include "Pixel/Texture.hpp"
+
+namespace Pixel {
+  struct TextureImage {
+    glm::uvec2           size = {};
+    std::vector<uint8_t> pixels;  // Tightly packed RGBA8
+  };
+
+  uint32_t MipLevelCount(const glm::uvec2& size);
+
+  TextureImage              DownsampleBox(const TextureImage& image);
+  TextureImage              DownsampleKaiser(const TextureImage& image);
+  std::vector<TextureImage> GenerateMipChain(const TextureImage& base, MipFilter filter = MipFilter::box);
+}
+
+#endif
@@ -0,0 +1,118 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_METRICS_HPP
+#define PIXEL_METRICS_HPP
+
+#include "pch.hpp"
+
+namespace Pixel {
+  enum class MetricUnit : uint8_t {
+    seconds = 0,
+    count   = 1,
+    bytes   = 2,
+  };
+
+  // Log-linear histogram in the spirit of HdrHistogram: every power of two is split into 16 linear buckets, so any
+  // recorded value is known to within about 6% no matter its magnitude, in a fixed 4KB table.
+  class Histogram {
+   public:
+    void Record(uint64_t value);
+    void Reset();
+
+    uint64_t Count() const { return pCount; }
+    uint64_t Max() const { return pMax; }
+    uint64_t Percentile(float percentile) const;  // Upper bound of the bucket holding it, percentile in [0, 100]
+
+    static uint32_t BucketOf(uint64_t value);
+    static uint64_t BucketUpperBound(uint32_t bucket);
+
+   public:
+    static constexpr uint32_t pSubBuckets = 16;
+    static constexpr uint32_t pBuckets    = pSubBuckets * 61;
+
+   private:
+    std::array<uint32_t, pBuckets> pCounts = {};
+    uint64_t                       pCount  = 0;
+    uint64_t                       pMax    = 0;
+  };
+
+  struct MetricSummary {
+    float last = 0.f;
+    float mean = 0.f;
+    float p50  = 0.f;
+    float p95  = 0.f;
+    float p99  = 0.f;
+    float max  = 0.f;
+  };
+
+  // One sample per frame kept in a ring of the last pCapacity frames, plus a histogram over every sample since the
+  // last Reset. Nothing allocates after construction.
+  class Metric {
+   public:
+    Metric(std::string_view name, MetricUnit unit);
+
+    void Record(float value);
+    void Reset();
+
+    const std::string& Name() const { return pName; }
+    MetricUnit         Unit() const { return pUnit; }
+
+    float    Last() const;
+    float    Mean(uint32_t samples = pCapacity) const;  // Over the most recent samples
+    uint32_t Count() const { return pCount; }
+    float    Sample(uint32_t age) const;  // 0 is the most recent
+
+    MetricSummary    Summary() const;  // Over the ring window
+    const Histogram& History() const { return pHistogram; }
+    float            HistoryPercentile(float percentile) const;  // Over every sample, in the metric's unit
+
+   public:
+    static constexpr uint32_t pCapacity = 512;
+
+   private:
+    std::string pName;
+    MetricUnit  pUnit;
+    float       pHistogramScale;
+
+    std::array<float, pCapacity> pSamples = {};
+    uint32_t                     pHead    = 0;
+    uint32_t                     pCount   = 0;
+
+    mutable std::array<float, pCapacity> pScratch = {};
+
+    Histogram pHistogram;
+  };
+
+  class MetricsRegistry {
+   public:
+    uint32_t Register(std::string_view name, MetricUnit unit);
+
+    void Record(uint32_t id, float value) { pMetrics[id]->Record(value); }
+    void Reset();
+
+    const Metric& Get(uint32_t id) const { return *pMetrics[id]; }
+    const Metric* Find(std::string_view name) const;
+    uint32_t      Size() const { return (uint32_t)pMetrics.size(); }
+
+   private:
+    std::vector<std::unique_ptr<Metric>> pMetrics;
+  };
+}
+
+#endif
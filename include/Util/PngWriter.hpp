@@ -0,0 +1,71 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_PNGWRITER_HPP
+#define PIXEL_PNGWRITER_HPP
+
+#include "pch.hpp"
+
+namespace Pixel {
+  // Writes an 8 bit RGB or RGBA PNG one row at a time, top row first, so images far larger than memory can be
+  // produced. Rows are Sub filtered and deflated with fixed Huffman codes and a single-probe LZ77 matcher, which is
+  // fast and compresses flat diagram content well, at the cost of ratio on noisy images.
+  class PngWriter {
+   public:
+    bool Open(const std::filesystem::path& filepath, const glm::uvec2& size, uint32_t channels = 4);
+    void WriteRow(const uint8_t* row);
+    bool Close();
+
+    bool     IsOpen() const { return pFile.is_open(); }
+    uint32_t RowsWritten() const { return pRowsWritten; }
+
+   private:
+    void pDeflate(const uint8_t* data, uint32_t size, bool final);
+    void pWriteBits(uint32_t bits, uint32_t count);
+    void pWriteCode(uint32_t code, uint32_t length);
+    void pWriteLiteral(uint32_t symbol);
+    void pWriteMatch(uint32_t length, uint32_t distance);
+    void pFlushChunk(bool force);
+    void pWriteChunk(const char* type, const uint8_t* data, uint32_t size);
+
+   private:
+    static constexpr uint32_t pWindowSize = 32768;
+    static constexpr uint32_t pHashBits   = 15;
+    static constexpr uint32_t pChunkSize  = 1 << 16;
+
+    std::ofstream pFile;
+
+    glm::uvec2 pSize        = {};
+    uint32_t   pChannels    = 4;
+    uint32_t   pRowsWritten = 0;
+    uint32_t   pAdler       = 1;
+
+    std::vector<uint8_t> pFiltered;
+
+    // Sliding window of already compressed bytes plus the bytes being compressed, positions are absolute
+    std::vector<uint8_t> pHistory;
+    uint64_t             pHistoryBase = 0;
+    std::vector<int64_t> pHashHeads;
+
+    std::vector<uint8_t> pOutput;
+    uint64_t             pBitBuffer = 0;
+    uint32_t             pBitCount  = 0;
+  };
+}
+
+#endif
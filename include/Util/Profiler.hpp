@@ -0,0 +1,98 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_PROFILER_HPP
+#define PIXEL_PROFILER_HPP
+
+#include "pch.hpp"
+
+namespace Pixel {
+  struct ProfileZoneTotal {
+    const char* name  = nullptr;
+    uint64_t    time  = 0;  // Inclusive, in nanoseconds
+    uint32_t    calls = 0;
+  };
+
+  // Collects CPU zones into one ring buffer per thread. Only the owning thread writes its ring, so recording is a
+  // couple of stores and a release increment; when nothing is being recorded a zone costs two relaxed loads. Zone names
+  // must outlive the capture, string literals and __func__ are the intended use.
+  class Profiler {
+   public:
+    static void BeginCapture(uint32_t frames = 0);  // 0 records until EndCapture
+    static void EndCapture();
+    static bool Capturing() { return pCapturing.load(std::memory_order_relaxed); }
+
+    // Live recording keeps the rings filling outside of captures, so the last frame can be inspected
+    static void SetLive(bool live) { pLive = live; }
+    static bool Recording() {
+      return pCapturing.load(std::memory_order_relaxed) || pLive.load(std::memory_order_relaxed);
+    }
+
+    static void     FrameMark();
+    static uint32_t LastFrameZones(ProfileZoneTotal* zones, uint32_t max_zones);  // Calling thread, slowest first
+
+    static void SetThreadName(const char* name);
+
+    static bool WriteChromeTrace(const std::filesystem::path& filepath);
+
+    static uint64_t Now();
+    static void     Record(const char* name, uint64_t begin, uint64_t end);
+
+   public:
+    static constexpr uint32_t pRingSize = 1 << 16;
+
+   private:
+    static std::atomic<bool>     pCapturing;
+    static std::atomic<bool>     pLive;
+    static std::atomic<uint32_t> pFramesLeft;
+    static std::atomic<uint64_t> pCaptureBegin;
+    static std::atomic<uint64_t> pCaptureEnd;
+  };
+
+  class ProfileScope {
+   public:
+    explicit ProfileScope(const char* name) : pName(name), pBegin(Profiler::Recording() ? Profiler::Now() : 0) {}
+    ~ProfileScope() {
+      if (pBegin != 0) Profiler::Record(pName, pBegin, Profiler::Now());
+    }
+
+    ProfileScope(const ProfileScope&)            = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+   private:
+    const char* pName;
+    uint64_t    pBegin;
+  };
+}
+
+#ifdef PIXEL_PROFILING
+  #define PIXEL_PROFILE_CONCAT_INNER(a, b) a##b
+  #define PIXEL_PROFILE_CONCAT(a, b)       PIXEL_PROFILE_CONCAT_INNER(a, b)
+
+  #define PIXEL_PROFILE_SCOPE(name) ::Pixel::ProfileScope PIXEL_PROFILE_CONCAT(pixel_profile_, __LINE__)(name)
+  #define PIXEL_PROFILE_FUNCTION()   PIXEL_PROFILE_SCOPE(__func__)
+  #define PIXEL_PROFILE_FRAME()      ::Pixel::Profiler::FrameMark()
+  #define PIXEL_PROFILE_THREAD(name) ::Pixel::Profiler::SetThreadName(name)
+#else
+  #define PIXEL_PROFILE_SCOPE(name)  ((void)0)
+  #define PIXEL_PROFILE_FUNCTION()   ((void)0)
+  #define PIXEL_PROFILE_FRAME()      ((void)0)
+  #define PIXEL_PROFILE_THREAD(name) ((void)0)
+#endif
+
+#endif
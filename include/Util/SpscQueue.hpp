@@ -0,0 +1,64 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_SPSC_QUEUE_HPP
+#define PIXEL_SPSC_QUEUE_HPP
+
+#include "pch.hpp"
+
+namespace Pixel {
+  // Fixed ring for exactly one producer thread and one consumer thread, neither of which ever blocks. Push fails
+  // while the ring is full, or once it would leave fewer than reserve slots free, which lets the producer keep room
+  // for what matters most. The indices only ever grow and wrap around, so full and empty never look alike.
+  template <typename T, uint32_t Capacity>
+  class SpscQueue {
+    static_assert(std::has_single_bit(Capacity), "SpscQueue capacity must be a power of two");
+
+   public:
+    bool Push(const T& value, uint32_t reserve = 0) {
+      const uint32_t head = pHead.load(std::memory_order_relaxed);
+      if (head - pTail.load(std::memory_order_acquire) + reserve >= Capacity) return false;
+
+      pSlots[head & pMask] = value;
+      pHead.store(head + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    bool Pop(T& value) {
+      const uint32_t tail = pTail.load(std::memory_order_relaxed);
+      if (tail == pHead.load(std::memory_order_acquire)) return false;
+
+      value = pSlots[tail & pMask];
+      pTail.store(tail + 1, std::memory_order_release);
+
+      return true;
+    }
+
+   private:
+    static constexpr uint32_t pMask = Capacity - 1;
+
+    // On separate cache lines so the two threads do not invalidate each other's index on every operation
+    alignas(64) std::atomic<uint32_t> pHead {0};
+    alignas(64) std::atomic<uint32_t> pTail {0};
+
+    std::array<T, Capacity> pSlots = {};
+  };
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXEL_TRIPLE_BUFFER_HPP
+#define PIXEL_TRIPLE_BUFFER_HPP
+
+#include "pch.hpp"
+
+namespace Pixel {
+  // Hands snapshots from one writer thread to one reader thread without either ever waiting on the other. The writer
+  // fills Back and publishes it, the reader always gets the newest published snapshot; ones it never saw are dropped.
+  template <typename T>
+  class TripleBuffer {
+   public:
+    // Writer side, Back keeps its contents until published, after which it holds an older snapshot
+    T&   Back() { return pSlots[pBack]; }
+    void Publish() { pBack = pMiddle.exchange(pBack | pFresh, std::memory_order_acq_rel) & pIndex; }
+
+    // Reader side, returns whether a snapshot newer than the current Front was taken
+    bool Acquire() {
+      if (!(pMiddle.load(std::memory_order_relaxed) & pFresh)) return false;
+
+      pFront = pMiddle.exchange(pFront, std::memory_order_acq_rel) & pIndex;
+      return true;
+    }
+
+    const T& Front() const { return pSlots[pFront]; }
+
+   private:
+    static constexpr uint8_t pIndex = 0b011;
+    static constexpr uint8_t pFresh = 0b100;
+
+    std::array<T, 3>     pSlots = {};
+    uint8_t              pBack  = 0;
+    uint8_t              pFront = 1;
+    std::atomic<uint8_t> pMiddle {2};
+  };
+}
+
+#endif
@@ -38,6 +38,15 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <condition_variable>
 #include <functional>
 #include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <array>
+#include <mutex>
+#include <deque>
+#include <cstdio>
+#include <limits>
+#include <bit>
+#include <source_location>
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -25,8 +25,14 @@ in float our_tex_index;
 out vec4 color;
 
 uniform sampler2D u_textures[8];
+uniform int       u_debug_view;
+uniform vec3      u_debug_color;
 
 void main() {
   int index = int(our_tex_index);
   color = texture(u_textures[index], our_tex_coord) * our_color;
+
+  if (u_debug_view == 1) color = vec4(1.0f);
+  if (u_debug_view == 2) color = vec4(mix(color.rgb, u_debug_color, 0.75f), max(color.a, 0.5f));
+  if (u_debug_view == 3) color = vec4(our_color.rgb, 1.0f);
 }
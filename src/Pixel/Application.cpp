@@ -18,21 +18,88 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "pch.hpp"
 #include "Pixel/Application.hpp"
+#include "Pixel/Renderer.hpp"
 #include "Util/Logger.hpp"
+#include "Util/PngWriter.hpp"
+#include "Util/Profiler.hpp"
 
 namespace Pixel {
   static void glfw_error_callback(int error, const char* description) {
     Logger::Die("GLFW error code " + std::to_string(error) + ": " + std::string(description));
   }
 
+  // Every Renderer::Stats counter gets a per-frame metric, recorded as the difference to the previous frame
+  static constexpr std::pair<const char*, uint32_t Renderer::Stats::*> renderer_counters[] = {
+      {"renderer.quads_drawn", &Renderer::Stats::quads_drawn},
+      {"renderer.quads_outlined", &Renderer::Stats::quads_outlined},
+      {"renderer.tris_drawn", &Renderer::Stats::tris_drawn},
+      {"renderer.tris_outlined", &Renderer::Stats::tris_outlined},
+      {"renderer.tris_bordered", &Renderer::Stats::tris_bordered},
+      {"renderer.lines_drawn", &Renderer::Stats::lines_drawn},
+      {"renderer.wide_lines_drawn", &Renderer::Stats::wide_lines_drawn},
+      {"renderer.circles_drawn", &Renderer::Stats::circles_drawn},
+      {"renderer.circles_outlined", &Renderer::Stats::circles_outlined},
+      {"renderer.circles_bordered", &Renderer::Stats::circles_bordered},
+      {"renderer.semicircles_bordered", &Renderer::Stats::semicircles_bordered},
+      {"renderer.draw_calls", &Renderer::Stats::draw_calls},
+      {"renderer.tri_vertex_count", &Renderer::Stats::tri_vertex_count},
+      {"renderer.tri_index_count", &Renderer::Stats::tri_index_count},
+      {"renderer.line_vertex_count", &Renderer::Stats::line_vertex_count},
+      {"renderer.line_index_count", &Renderer::Stats::line_index_count},
+  };
+
+  static float SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  uint32_t AntialiasingSamples(Antialiasing antialiasing) {
+    switch (antialiasing) {
+      case Antialiasing::msaa_2x:
+        return 2;
+
+      case Antialiasing::msaa_4x:
+        return 4;
+
+      case Antialiasing::msaa_8x:
+        return 8;
+
+      default:
+        return 0;
+    }
+  }
+
   void Application::Construct(const glm::uvec2& size,
                               const glm::uvec2& position,
                               const char*       name,
-                              glm::vec4         clear_color) {
-    pWindowSize = size;
-    pWindowPos  = position;
-    pWindowName = name;
-    pClearColor = clear_color;
+                              glm::vec4         clear_color,
+                              Antialiasing      antialiasing) {
+    pWindowSize   = size;
+    pWindowPos    = position;
+    pWindowName   = name;
+    pClearColor   = clear_color;
+    pAntialiasing = antialiasing;
+
+    if (pMetrics.Size() == 0) {
+      pFrameTimeMetric  = pMetrics.Register("frame.time", MetricUnit::seconds);
+      pUpdateTimeMetric = pMetrics.Register("frame.update_time", MetricUnit::seconds);
+      pImGuiTimeMetric  = pMetrics.Register("frame.imgui_time", MetricUnit::seconds);
+      pRenderTimeMetric = pMetrics.Register("frame.render_time", MetricUnit::seconds);
+      pGpuTimeMetric    = pMetrics.Register("frame.gpu_time", MetricUnit::seconds);
+      pFixedStepsMetric = pMetrics.Register("frame.fixed_steps", MetricUnit::count);
+      pJitterMetric     = pMetrics.Register("frame.jitter", MetricUnit::seconds);
+
+      pInputDroppedMetric = pMetrics.Register("input.dropped", MetricUnit::count);
+
+#ifdef PIXEL_METRICS
+      pFirstCounterMetric = pMetrics.Size();
+      for (const auto& [name, counter] : renderer_counters) pMetrics.Register(name, MetricUnit::count);
+
+      pFirstFlushMetric = pMetrics.Size();
+      for (uint32_t reason = 0; reason < (uint32_t)FlushReason::count; reason++) {
+        pMetrics.Register(std::string("renderer.flushes.") + FlushReasonName((FlushReason)reason), MetricUnit::count);
+      }
+#endif
+    }
 
     pHasBeenConstructed = true;
   }
@@ -51,6 +118,23 @@ namespace Pixel {
     }
   }
 
+  void Application::LaunchHeadless(HeadlessContext context, bool background) {
+    if (pHasBeenClosed) Logger::Die("Trying to launch an application which has already been closed");
+    if (!pHasBeenConstructed) Logger::Die("Trying to launch an application without constructing it first");
+
+    pHeadless        = true;
+    pHeadlessContext = context;
+
+    std::thread thread(&Application::pHeadlessThread, this);
+
+    if (background) {
+      thread.detach();
+
+    } else {
+      thread.join();
+    }
+  }
+
   void Application::Close() { pWantsToClose = true; }
 
   void Application::EnsureClosed() {
@@ -74,10 +158,102 @@ namespace Pixel {
   const Mouse&    Application::MouseState() const { return pMouse; }
   const Keyboard& Application::KeyboardState() const { return pKeyboard; }
 
-  float    Application::et() const { return pElapsedTime; }
-  uint32_t Application::fps() const { return pFrameRate; }
+  const std::vector<InputEvent>& Application::InputEvents() const { return pInputEvents; }
+
+  float Application::et() const {
+    if (pCapturing && pCaptureSettings.fixed_timestep > 0.f) return pCaptureSettings.fixed_timestep;
+    return pMetrics.Get(pFrameTimeMetric).Last();
+  }
+
+  // Averaged over the last 60 frames, enough to be steady without hiding a change in load for long
+  uint32_t Application::fps() const {
+    const float frame_time = pMetrics.Get(pFrameTimeMetric).Mean(60);
+    return frame_time > 0.f ? (uint32_t)std::lround(1.f / frame_time) : 0;
+  }
+
+  JobSystem& Application::Jobs() { return JobSystem::Default(); }
+
+  const MetricsRegistry& Application::Metrics() const { return pMetrics; }
+  MetricsRegistry&       Application::Metrics() { return pMetrics; }
+
+  void Application::EnableFixedTimestep(const FixedTimestepSettings& settings) {
+    pPendingFixedSettings = settings;
+    pFixedRequested       = true;
+  }
+
+  void Application::DisableFixedTimestep() { pFixedStopRequested = true; }
+
+  bool                         Application::FixedTimestep() const { return pFixedEnabled; }
+  const FixedTimestepSettings& Application::FixedTimestepConfig() const { return pFixedSettings; }
+  float                        Application::InterpolationAlpha() const { return pInterpolationAlpha; }
+
+  void     Application::SetFramePipelining(uint32_t depth) { pPipelineDepth = std::min(depth, 2u); }
+  uint32_t Application::FramePipelining() const { return pPipelineDepth; }
+
+  void Application::SetFramePacing(const FramePacingSettings& settings) {
+    pPendingPacing   = settings;
+    pPacingRequested = true;
+  }
+
+  const FramePacingSettings& Application::FramePacing() const { return pPacing; }
+
+  void Application::EnableDynamicResolution(const DynamicResolutionSettings& settings) {
+    pDynamicResolution.Configure(settings);
+    pDynamicResolutionEnabled = true;
+  }
+
+  void Application::DisableDynamicResolution() { pDynamicResolutionEnabled = false; }
+
+  float Application::ResolutionScale() const { return pDynamicResolutionEnabled ? pDynamicResolution.Scale() : 1.f; }
+
+  const glm::uvec2&        Application::RenderResolution() const { return pRenderResolution; }
+  const DynamicResolution& Application::ResolutionController() const { return pDynamicResolution; }
+
+  bool                Application::Headless() const { return pHeadless; }
+  const RenderTarget& Application::HeadlessTarget() const { return pHeadlessTarget; }
+
+  // Requests are taken by pUpdateFrame and travel with its frame to the graphics thread, which needs the GL context
+  void Application::StartCapture(const CaptureSettings& settings) {
+    pPendingCapture   = settings;
+    pCaptureRequested = true;
+  }
+
+  void Application::StopCapture() { pCaptureStopRequested = true; }
+
+  bool                   Application::Capturing() const { return pCapturing; }
+  const CaptureSettings& Application::CaptureConfig() const { return pCaptureSettings; }
+  uint64_t               Application::CapturedFrames() const { return pCapture.FramesWritten(); }
+
+  void Application::StartRecording(const std::filesystem::path& filepath, uint32_t frames) {
+    pPendingRecording       = filepath;
+    pPendingRecordingFrames = frames;
+    pRecordingRequested     = true;
+  }
+
+  void Application::StopRecording() { pRecordingStopRequested = true; }
+
+  bool                   Application::Recording() const { return pRecorder.Active(); }
+  const CommandRecorder& Application::Recorder() const { return pRecorder; }
+
+  void Application::ExportTiled(const OrthographicCamera& camera, const TiledExportSettings& settings) {
+    pPendingExport               = settings;
+    pPendingExportViewProjection = camera.getViewProjectionMatrix();
+    pExportRequested             = true;
+  }
+
+  bool Application::Exporting() const { return pExportRequested; }
+
+  // The profiler keeps recording while the HUD is up so it can list last frame's zones without a capture running
+  void Application::ShowPerfHud(bool visible) {
+    pPerfHudVisible = visible;
+    Profiler::SetLive(visible);
+  }
+
+  bool Application::PerfHudVisible() const { return pPerfHudVisible; }
+  void Application::SetPerfHudKey(Pixel::KeyboardKey key) { pPerfHudKey = key; }
 
   rcode Application::pOnUpdate() { return rcode::ok; }
+  rcode Application::pOnFixedUpdate(float dt) { return rcode::ok; }
   rcode Application::pOnLaunch() { return rcode::ok; }
   rcode Application::pOnImGuiRender() { return rcode::ok; }
   rcode Application::pOnRender() { return rcode::ok; }
@@ -104,21 +280,25 @@ namespace Pixel {
     auto         pos          = glm::vec2(posx, posy);
 
     if (!((pos.x > app_instance->pWindowSize.x) || (pos.y > app_instance->pWindowSize.y))) {
-      app_instance->pMouse.pos =
-          (pos / (glm::vec2)app_instance->pWindowSize) * glm::vec2(2.f, 2.f) - glm::vec2(1.f, 1.f);
+      InputEvent event = {InputEventType::mouse_move};
+      event.value      = (pos / (glm::vec2)app_instance->pWindowSize) * glm::vec2(2.f, 2.f) - glm::vec2(1.f, 1.f);
+
+      app_instance->pPushInput(event);
     }
   }
 
   void Application::pHandleMouseButton(GLFWwindow* window, int button, int action, int mods) {
     Application* app_instance = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+    InputEvent   event        = {InputEventType::mouse_button, false, (uint16_t)button};
 
     switch (action) {
       case GLFW_RELEASE:
-        app_instance->pMouse.state_new[button] = false;
+        app_instance->pPushInput(event);
         break;
 
       case GLFW_PRESS:
-        app_instance->pMouse.state_new[button] = true;
+        event.pressed = true;
+        app_instance->pPushInput(event);
         break;
 
       default:
@@ -128,25 +308,32 @@ namespace Pixel {
 
   void Application::pHandleMouseScroll(GLFWwindow* window, double deltax, double deltay) {
     Application* app_instance = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
-    app_instance->pMouse.wheel += glm::vec2(deltax, deltay);
+
+    InputEvent event = {InputEventType::mouse_scroll};
+    event.value      = glm::vec2(deltax, deltay);
+
+    app_instance->pPushInput(event);
   }
 
   void Application::pHandleMouseEnter(GLFWwindow* window, int enter) {
-    Application* app_instance    = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
-    app_instance->pHasMouseFocus = enter;
+    Application* app_instance = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+    app_instance->pPushInput({InputEventType::mouse_enter, enter == GLFW_TRUE});
   }
 
   void Application::pHandleKeyboardKey(GLFWwindow* window, int key, int scancode, int action, int mods) {
     Application* app_instance = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
     if (key == -1) key = 0;
 
+    InputEvent event = {InputEventType::key, false, (uint16_t)key};
+
     switch (action) {
       case GLFW_RELEASE:
-        app_instance->pKeyboard.state_new[key] = false;
+        app_instance->pPushInput(event);
         break;
 
       case GLFW_PRESS:
-        app_instance->pKeyboard.state_new[key] = true;
+        event.pressed = true;
+        app_instance->pPushInput(event);
         break;
 
       default:
@@ -154,6 +341,86 @@ namespace Pixel {
     }
   }
 
+  // Runs on the platform thread, the only producer. The last slots of the queue are kept for keys, buttons and focus
+  // changes, so a stall cannot leave a release stuck behind mouse motion: once motion would reach them, moves collapse
+  // into the latest position and scrolls into their sum until the frame loop catches up. Only a full queue drops
+  // events, which input.dropped counts.
+  void Application::pPushInput(InputEvent event) {
+    event.time = std::chrono::steady_clock::now();
+
+    if (event.type == InputEventType::mouse_move || event.type == InputEventType::mouse_scroll) {
+      const bool  move  = event.type == InputEventType::mouse_move;
+      InputEvent& held  = move ? pHeldMove : pHeldScroll;
+      bool&       valid = move ? pMoveHeld : pScrollHeld;
+
+      if (valid && !move) event.value += held.value;
+
+      held  = event;
+      valid = true;
+
+      pFlushHeldMotion(pMotionReserve);
+      return;
+    }
+
+    // Motion that came first goes first, it may use the reserve since there is at most one of each
+    pFlushHeldMotion(0);
+    if (!pInputQueue.Push(event)) pInputDropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Application::pFlushHeldMotion(uint32_t reserve) {
+    if (pScrollHeld && pInputQueue.Push(pHeldScroll, reserve)) pScrollHeld = false;
+    if (pMoveHeld && pInputQueue.Push(pHeldMove, reserve)) pMoveHeld = false;
+  }
+
+  // Only buttons that changed last frame have edges to clear, and a press and a release within one frame both register
+  // instead of cancelling out
+  void Application::pProcessInput() {
+    for (Button* button : pChangedButtons) {
+      button->pressed  = false;
+      button->released = false;
+    }
+
+    pChangedButtons.clear();
+    pInputEvents.clear();
+
+    pMetrics.Record(pInputDroppedMetric, (float)pInputDropped.exchange(0, std::memory_order_relaxed));
+
+    for (InputEvent event; pInputQueue.Pop(event);) {
+      switch (event.type) {
+        case InputEventType::key:
+        case InputEventType::mouse_button: {
+          Button& button = event.type == InputEventType::key ? pKeyboard.state[event.code] : pMouse.state[event.code];
+
+          if (event.pressed) {
+            button.pressed = button.pressed || !button.held;
+            button.held    = true;
+
+          } else {
+            button.released = true;
+            button.held     = false;
+          }
+
+          pChangedButtons.push_back(&button);
+          break;
+        }
+
+        case InputEventType::mouse_move:
+          pMouse.pos = event.value;
+          break;
+
+        case InputEventType::mouse_scroll:
+          pMouse.wheel += event.value;
+          break;
+
+        case InputEventType::mouse_enter:
+          pHasMouseFocus = event.pressed;
+          break;
+      }
+
+      pInputEvents.push_back(event);
+    }
+  }
+
   void Application::pPlatformThread() {
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit()) Logger::Die("GLFW initialization failed");
@@ -162,7 +429,7 @@ namespace Pixel {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    glfwWindowHint(GLFW_SAMPLES, AntialiasingSamples(pAntialiasing));
 
     pWindow = glfwCreateWindow(pWindowSize.x, pWindowSize.y, "Pixel", NULL, NULL);
     if (!pWindow) Logger::Die("GLFW window creation failed");
@@ -184,16 +451,230 @@ namespace Pixel {
 
     while (!pHasBeenClosed) {
       if (glfwWindowShouldClose(pWindow)) pWantsToClose = true;
-      glfwWaitEvents();
+
+      // Held motion has to reach the queue even if no further events come to push it along
+      if (pMoveHeld || pScrollHeld) {
+        glfwWaitEventsTimeout(.005);
+        pFlushHeldMotion(pMotionReserve);
+
+      } else {
+        glfwWaitEvents();
+      }
     }
 
     glfwDestroyWindow(pWindow);
     glfwTerminate();
   }
 
+  void Application::pHeadlessThread() {
+    glfwSetErrorCallback(glfw_error_callback);
+
+    // The null platform never talks to a display server, and its EGL path goes through EGL_MESA_platform_surfaceless
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (!glfwInit()) Logger::Die("GLFW initialization failed");
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+                   pHeadlessContext == HeadlessContext::osmesa ? GLFW_OSMESA_CONTEXT_API : GLFW_EGL_CONTEXT_API);
+
+    pWindow = glfwCreateWindow(pWindowSize.x, pWindowSize.y, "Pixel", NULL, NULL);
+    if (!pWindow) Logger::Die("GLFW headless context creation failed");
+
+    glfwSetWindowUserPointer(pWindow, (void*)this);
+    pFrameBufferSize = pWindowSize;
+
+    // There are no events to wait on, so the graphics loop runs straight on this thread
+    pGraphicsThread();
+
+    glfwDestroyWindow(pWindow);
+    glfwTerminate();
+  }
+
+  GLuint Application::pOutputFramebuffer() const { return pHeadless ? pHeadlessTarget.getFramebuffer() : 0; }
+
+  // Dynamic resolution is configured from the update side, so only what the frame carries is read here
+  void Application::pBeginWorldPass(const FramePacket& frame) {
+    pDrawResolution = frame.offscreen ? frame.render_resolution : pFrameBufferSize;
+
+    if (frame.offscreen) {
+      // The target is sized for the largest scale, smaller scales only shrink the viewport so nothing is reallocated
+      const glm::uvec2 target_size = glm::vec2(pFrameBufferSize) * frame.max_scale;
+
+      if (pWorldTarget.getFramebuffer() == 0) {
+        pWorldTarget.Create(target_size, GL_RGBA8, AntialiasingSamples(pAntialiasing));
+
+      } else {
+        pWorldTarget.Resize(target_size);
+      }
+
+      // A pipelined frame's resolution was chosen for the framebuffer a frame or two ago, which may have shrunk since
+      pDrawResolution = glm::max(glm::min(pDrawResolution, pWorldTarget.Size()), glm::uvec2(1));
+
+      glBindFramebuffer(GL_FRAMEBUFFER, pWorldTarget.getFramebuffer());
+
+    } else {
+      if (pWorldTarget.getFramebuffer() != 0) pWorldTarget.Release();
+      glBindFramebuffer(GL_FRAMEBUFFER, pOutputFramebuffer());
+    }
+
+    glViewport(0, 0, pDrawResolution.x, pDrawResolution.y);
+    Renderer::gpu_timer.Begin(GpuPhase::world);
+  }
+
+  void Application::pEndWorldPass() {
+    Renderer::gpu_timer.End(GpuPhase::world);
+
+    if (pWorldTarget.getFramebuffer() != 0) {
+      Renderer::gpu_timer.Begin(GpuPhase::post_process);
+
+      pWorldTarget.Resolve(pDrawResolution);
+
+      glBindFramebuffer(GL_FRAMEBUFFER, pOutputFramebuffer());
+      glViewport(0, 0, pFrameBufferSize.x, pFrameBufferSize.y);
+
+      // A draw rather than a blit, blits into a multisampled output framebuffer are not allowed
+      const glm::vec2 uv_scale = glm::vec2(pDrawResolution) / glm::vec2(pWorldTarget.Size());
+      auto&           pass     = pAntialiasing == Antialiasing::fxaa ? pFxaaPass : pBlitPass;
+      pass.Draw(pWorldTarget, pWorldTarget.Size(), uv_scale);
+
+      Renderer::gpu_timer.End(GpuPhase::post_process);
+    }
+
+    glViewport(0, 0, pFrameBufferSize.x, pFrameBufferSize.y);
+  }
+
+  void Application::pExportTiled() {
+    const TiledExportSettings& settings   = pPendingExport;
+    const glm::uvec2           resolution = settings.resolution;
+
+    GLint max_viewport[2], max_texture;
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, max_viewport);
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture);
+
+    const uint32_t   limit = std::min({max_viewport[0], max_viewport[1], max_texture});
+    const uint32_t   tile  = std::clamp<uint32_t>(settings.tile_size, 1, limit);
+    const glm::uvec2 tiles = (resolution + tile - 1u) / tile;
+
+    PngWriter png;
+
+    if (resolution.x == 0 || resolution.y == 0 || !png.Open(settings.output, resolution, 4)) {
+      Logger::Info("Cannot export to " + settings.output.string());
+      return;
+    }
+
+    // Tiles arrive in order on the single capture worker, which assembles one row of tiles and streams it out
+    std::vector<uint8_t> strip((size_t)resolution.x * tile * 4);
+
+    CaptureSettings capture;
+    capture.format   = CaptureFormat::callback;
+    capture.workers  = 1;
+    capture.callback = [&](uint64_t frame, const uint8_t* rgba, const glm::uvec2& size) {
+      const glm::uvec2 index  = {frame % tiles.x, frame / tiles.x};
+      const glm::uvec2 origin = index * tile;
+      const glm::uvec2 extent = glm::min(glm::uvec2(tile), resolution - origin);
+
+      for (uint32_t row = 0; row < extent.y; row++) {
+        std::memcpy(&strip[((size_t)row * resolution.x + origin.x) * 4],
+                    rgba + (size_t)(tile - 1 - row) * tile * 4,
+                    (size_t)extent.x * 4);
+      }
+
+      if (index.x + 1 < tiles.x) return;
+      for (uint32_t row = 0; row < extent.y; row++) png.WriteRow(&strip[(size_t)row * resolution.x * 4]);
+    };
+
+    RenderTarget target;
+    target.Create({tile, tile}, GL_RGBA8, AntialiasingSamples(pAntialiasing));
+
+    FrameCapture readback;
+    readback.Start(capture, target.Size());
+
+    for (uint32_t y = 0; y < tiles.y; y++) {
+      for (uint32_t x = 0; x < tiles.x; x++) {
+        // Maps this tile's slice of normalized device space onto the whole viewport, the top row of the image is at +y
+        const glm::vec2 ndc_min   = {-1.f + 2.f * x * tile / resolution.x, 1.f - 2.f * (y + 1) * tile / resolution.y};
+        const glm::vec2 ndc_size  = {2.f * tile / resolution.x, 2.f * tile / resolution.y};
+        const glm::vec2 ndc_scale = 2.f / ndc_size;
+
+        glm::mat4 tile_projection = glm::scale(glm::mat4(1.f), glm::vec3(ndc_scale, 1.f));
+        tile_projection           = glm::translate(tile_projection, glm::vec3(-(ndc_min + ndc_size * .5f), 0.f));
+
+        Renderer::SetViewProjectionOverride(tile_projection * pPendingExportViewProjection);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, target.getFramebuffer());
+        glViewport(0, 0, tile, tile);
+
+        glClearColor(
+            pClearColor.x * pClearColor.w, pClearColor.y * pClearColor.w, pClearColor.z * pClearColor.w, pClearColor.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        if (pOnRender() != rcode::ok) pThreadRunning = false;
+
+        target.Resolve();
+        readback.Capture(target.getTextureFramebuffer());
+      }
+    }
+
+    Renderer::ClearViewProjectionOverride();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    readback.Stop();
+    target.Release();
+
+    if (!png.Close()) Logger::Info("Failed writing " + settings.output.string());
+  }
+
+  // Steps are scheduled against absolute due times so sleep overshoot does not accumulate into drift
+  void Application::pFixedUpdateThread() {
+    using clock = std::chrono::steady_clock;
+
+    PIXEL_PROFILE_THREAD("Fixed update");
+
+    const float           dt   = pFixedSettings.step;
+    const clock::duration step = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(dt));
+    clock::time_point     due  = clock::now();
+
+    while (pFixedThreadRunning) {
+      // Further behind than max_steps, the backlog is dropped rather than chased
+      if (clock::now() - due > step * pFixedSettings.max_steps) due = clock::now();
+
+      {
+        PIXEL_PROFILE_SCOPE("pOnFixedUpdate");
+
+        if (pOnFixedUpdate(dt) != rcode::ok) {
+          pThreadRunning = false;
+          break;
+        }
+      }
+
+      pLastFixedStep = due.time_since_epoch().count();
+      pFixedSteps++;
+
+      due += step;
+      std::this_thread::sleep_until(due);
+    }
+  }
+
+  void Application::pStartFixedThread() {
+    pFixedThreadRunning = true;
+    pFixedThread        = std::thread(&Application::pFixedUpdateThread, this);
+  }
+
+  void Application::pStopFixedThread() {
+    if (!pFixedThread.joinable()) return;
+
+    pFixedThreadRunning = false;
+    pFixedThread.join();
+  }
+
   void Application::pGraphicsThread() {
     glfwMakeContextCurrent(pWindow);
-    glfwSwapInterval(true);
+
+    if (pPacingRequested.exchange(false)) pPacing = pPendingPacing;
+    pApplySwapInterval();
 
     glewExperimental = GL_TRUE;
     if (!!glewInit()) Logger::Die("GLEW initialization failed");
@@ -201,7 +682,13 @@ namespace Pixel {
     std::cout << "[INFO] Using " << glGetString(GL_RENDERER) << " driver with opengl " << glGetString(GL_VERSION)
               << "\n";
 
-    glEnable(GL_MULTISAMPLE);
+    if (AntialiasingSamples(pAntialiasing) > 0) {
+      glEnable(GL_MULTISAMPLE);
+
+    } else {
+      glDisable(GL_MULTISAMPLE);
+    }
+
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -211,103 +698,438 @@ namespace Pixel {
     ImGui_ImplGlfw_InitForOpenGL(pWindow, true);
     ImGui_ImplOpenGL3_Init(NULL);
 
+    // Builds the font atlas, which ImGui::NewFrame needs and which may be on the update thread when pipelining
+    ImGui_ImplOpenGL3_NewFrame();
+
     ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_DockingEnable;
 
-    pClock1 = std::chrono::system_clock::now();
-    pClock2 = std::chrono::system_clock::now();
+    if (pHeadless) pHeadlessTarget.Create(pFrameBufferSize, GL_RGBA8, AntialiasingSamples(pAntialiasing));
+
+    Renderer::gpu_timer.Create();
+    Renderer::SetRecorder(&pRecorder);
+    pBlitPass.Create(blit_fragment_shader_code);
+    if (pAntialiasing == Antialiasing::fxaa) pFxaaPass.Create(fxaa_fragment_shader_code);
+
+    // Renderer::Init in pOnLaunch picks this up, with no packet bound it draws straight through to OpenGL
+    if (pPipelineDepth > 0) {
+      pFrameQueue.Create(pPipelineDepth);
+      pPacketBackend.SetTarget(&pGlBackend);
+      Renderer::SetBackend(&pPacketBackend);
+    }
+
+    pClock1    = std::chrono::steady_clock::now();
+    pClock2    = std::chrono::steady_clock::now();
+    pNextFrame = std::chrono::steady_clock::now();
 
     pThreadRunning = pOnLaunch() == rcode::ok ? true : false;
 
-    while (pThreadRunning) {
-      while (pThreadRunning) {
-        pClock2       = std::chrono::system_clock::now();
-        pElapsedTimer = pClock2 - pClock1;
-        pClock1       = pClock2;
-        pElapsedTime  = pElapsedTimer.count();
+    PIXEL_PROFILE_THREAD("Graphics");
 
-        pFrameTimer += pElapsedTime;
-        pFrameCount++;
+    while (pThreadRunning) {
+      if (pPipelineDepth > 0) {
+        pFrameQueue.Reopen();
+        std::thread update(&Application::pUpdateThread, this);
 
-        if (pFrameTimer >= 1.0f) {
-          pFrameRate = pFrameCount;
-          pFrameTimer -= 1.0f;
+        // Runs until the update thread stops and every frame it submitted has been drawn
+        while (FramePacket* packet = pFrameQueue.AcquireFilled()) {
+          PIXEL_PROFILE_SCOPE("Frame");
 
-          pWindowTittle = pWindowName + " - FPS: " + std::to_string(pFrameRate);
-          glfwSetWindowTitle(pWindow, pWindowTittle.c_str());
+          if (pExportRequested.exchange(false)) Logger::Info("Tiled export is not available while pipelining frames");
 
-          pFrameCount = 0;
+          pDrawFrame(*packet, true, std::chrono::steady_clock::now());
+          pFrameQueue.Recycle(packet);
         }
 
-        for (uint32_t i = 0; i < 8; i++) {
-          pMouse.state[i].pressed  = false;
-          pMouse.state[i].released = false;
+        update.join();
 
-          if (pMouse.state_new[i] != pMouse.state_old[i]) {
-            if (pMouse.state_new[i]) {
-              pMouse.state[i].pressed = !pMouse.state[i].held;
-              pMouse.state[i].held    = true;
+      } else {
+        while (pThreadRunning) {
+          PIXEL_PROFILE_SCOPE("Frame");
 
-            } else {
-              pMouse.state[i].released = true;
-              pMouse.state[i].held     = false;
-            }
+          if (pExportRequested) {
+            pExportTiled();
+            pExportRequested = false;
           }
 
-          pMouse.state_old[i] = pMouse.state_new[i];
+          const auto frame_start = std::chrono::steady_clock::now();
+
+          pUpdateFrame(pSerialFrame);
+          pDrawFrame(pSerialFrame, false, frame_start);
+          pFinishFrame(pSerialFrame);
+          pEndFrame();
         }
+      }
 
-        for (uint32_t i = 0; i < 512; i++) {
-          pKeyboard.state[i].pressed  = false;
-          pKeyboard.state[i].released = false;
+      // The fixed thread must not step state that pOnClose is tearing down
+      pStopFixedThread();
+      if (pOnClose() != rcode::ok) pThreadRunning = true;
+    }
 
-          if (pKeyboard.state_new[i] != pKeyboard.state_old[i]) {
-            if (pKeyboard.state_new[i]) {
-              pKeyboard.state[i].pressed = !pKeyboard.state[i].held;
-              pKeyboard.state[i].held    = true;
+    pCapture.Stop();
+    pCapturing = false;
+    pRecorder.Stop();
+    Renderer::SetRecorder(nullptr);
 
-            } else {
-              pKeyboard.state[i].released = true;
-              pKeyboard.state[i].held     = false;
-            }
-          }
+    if (pPipelineDepth > 0) {
+      Renderer::SetBackend(nullptr);
+      pFrameQueue.Release();
+    }
 
-          pKeyboard.state_old[i] = pKeyboard.state_new[i];
-        }
+    pWorldTarget.Release();
+    Renderer::gpu_timer.Release();
+    pBlitPass.Release();
+    pFxaaPass.Release();
+    pHeadlessTarget.Release();
 
-        if (pOnUpdate() != rcode::ok) pThreadRunning = false;
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
 
-        glViewport(0, 0, pFrameBufferSize.x, pFrameBufferSize.y);
+    pHasBeenClosed = true;
+  }
 
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+  // Produces frames into packets while the graphics thread draws the ones before. Timings of a drawn frame come back
+  // with its packet, so the metrics and the dynamic resolution controller trail by the pipeline depth.
+  void Application::pUpdateThread() {
+    PIXEL_PROFILE_THREAD("Update");
 
-        if (pOnImGuiRender() != rcode::ok) pThreadRunning = false;
+    while (pThreadRunning) {
+      FramePacket* packet = pFrameQueue.AcquireFree();
+      if (!packet) break;
 
-        ImGui::Render();
+      if (!pThreadRunning) {
+        pFrameQueue.Recycle(packet);
+        break;
+      }
 
-        glClearColor(
-            pClearColor.x * pClearColor.w, pClearColor.y * pClearColor.w, pClearColor.z * pClearColor.w, pClearColor.w);
-        glClear(GL_COLOR_BUFFER_BIT);
+      {
+        PIXEL_PROFILE_SCOPE("Frame");
 
-        if (pOnRender() != rcode::ok) pThreadRunning = false;
+        if (packet->drawn) pFinishFrame(*packet);
+        packet->Reset();
 
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(pWindow);
+        pUpdateFrame(*packet);
 
-        if (pWantsToClose) {
-          pThreadRunning = false;
-          pWantsToClose  = false;
+        pPacketBackend.Bind(packet);
+        pSubmitWorld();
+        pPacketBackend.Bind(nullptr);
+
+        packet->SetImGuiDrawData(ImGui::GetDrawData());
+        pEndFrame();
+      }
+
+      pFrameQueue.Submit(packet);
+    }
+
+    pFrameQueue.Close();
+  }
+
+  // Everything before drawing that belongs to the application's side of the frame: timing, requests, input, the
+  // fixed steps, pOnUpdate and ImGui
+  void Application::pUpdateFrame(FramePacket& frame) {
+    pClock2       = std::chrono::steady_clock::now();
+    pElapsedTimer = pClock2 - pClock1;
+    pClock1       = pClock2;
+
+    const float previous_time = pElapsedTime;
+    pElapsedTime              = pElapsedTimer.count();
+
+    pMetrics.Record(pFrameTimeMetric, pElapsedTime);
+    pMetrics.Record(pJitterMetric, std::abs(pElapsedTime - previous_time));
+    pTitleTimer += pElapsedTime;
+
+    if (pTitleTimer >= 1.0f) {
+      pTitleTimer -= 1.0f;
+
+      std::snprintf(pWindowTitle,
+                    sizeof(pWindowTitle),
+                    "%s - FPS: %u (p99 %.1f ms)",
+                    pWindowName.c_str(),
+                    fps(),
+                    pMetrics.Get(pFrameTimeMetric).Summary().p99 * 1000.f);
+
+      glfwSetWindowTitle(pWindow, pWindowTitle);
+    }
+
+    // Taken here so et() reads state owned by this thread, the frame carries them to the graphics thread
+    frame.capture_stop  = pCaptureStopRequested.exchange(false);
+    frame.capture_start = pCaptureRequested.exchange(false);
+
+    if (frame.capture_stop) pCapturing = false;
+
+    if (frame.capture_start) {
+      pCaptureSettings = pPendingCapture;
+      frame.capture    = pCaptureSettings;
+      pCapturing       = true;
+    }
+
+    if (pRecordingStopRequested.exchange(false)) pRecorder.Stop();
+    if (pRecordingRequested.exchange(false)) {
+      pRecorder.Start(pPendingRecording, pFrameBufferSize, pPendingRecordingFrames);
+    }
+
+    if (pFixedStopRequested.exchange(false)) {
+      pStopFixedThread();
+      pFixedEnabled = false;
+    }
+
+    if (pFixedRequested.exchange(false)) {
+      pStopFixedThread();
+
+      pFixedSettings      = pPendingFixedSettings;
+      pFixedSettings.step = std::max(pFixedSettings.step, 1e-4f);
+      pFixedEnabled       = true;
+      pFixedAccumulator   = 0.f;
+    }
+
+    // Also brings the thread back after a pOnClose that refused to close
+    if (pFixedEnabled && pFixedSettings.threaded && !pFixedThread.joinable()) pStartFixedThread();
+
+    Renderer::NewFrame();
+
+#ifdef PIXEL_METRICS
+    // Flushes are only complete once the frame is over, so these trail the other renderer counters by a frame
+    const FlushLog& flushes = Renderer::LastFrameFlushes();
+
+    for (uint32_t reason = 0; reason < (uint32_t)FlushReason::count; reason++) {
+      pMetrics.Record(pFirstFlushMetric + reason, (float)flushes.counts[reason]);
+    }
+#endif
+
+    {
+      PIXEL_PROFILE_SCOPE("Input");
+
+      pProcessInput();
+
+      if (pPerfHudKey != Pixel::KeyboardKey::KEY_UNKNOWN && KeyboardKey(pPerfHudKey).pressed) {
+        ShowPerfHud(!pPerfHudVisible);
+      }
+    }
+
+    {
+      PIXEL_PROFILE_SCOPE("pOnUpdate");
+      const auto update_start = std::chrono::steady_clock::now();
+
+      if (pFixedEnabled && !pFixedSettings.threaded) {
+        PIXEL_PROFILE_SCOPE("pOnFixedUpdate");
+
+        const float step  = pFixedSettings.step;
+        pFixedAccumulator = std::min(pFixedAccumulator + et(), step * pFixedSettings.max_steps);
+
+        while (pFixedAccumulator >= step && pThreadRunning) {
+          if (pOnFixedUpdate(step) != rcode::ok) pThreadRunning = false;
+
+          pFixedAccumulator -= step;
+          pFixedSteps++;
         }
+
+        pInterpolationAlpha = pFixedAccumulator / step;
+
+      } else if (pFixedEnabled) {
+        const auto since_step = std::chrono::steady_clock::now().time_since_epoch().count() - pLastFixedStep;
+        const auto step       = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float>(pFixedSettings.step));
+
+        pInterpolationAlpha = std::clamp((float)since_step / (float)step.count(), 0.f, .9999f);
+
+      } else {
+        pInterpolationAlpha = 0.f;
       }
 
-      if (pOnClose() != rcode::ok) pThreadRunning = true;
+      pMetrics.Record(pFixedStepsMetric, (float)pFixedSteps.exchange(0));
+
+      if (pOnUpdate() != rcode::ok) pThreadRunning = false;
+      pMetrics.Record(pUpdateTimeMetric, SecondsSince(update_start));
     }
 
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    const auto imgui_start = std::chrono::steady_clock::now();
 
-    pHasBeenClosed = true;
+    ImGui_ImplGlfw_NewFrame();
+    ImGui::NewFrame();
+
+    {
+      PIXEL_PROFILE_SCOPE("pOnImGuiRender");
+      if (pOnImGuiRender() != rcode::ok) pThreadRunning = false;
+
+      if (pPerfHudVisible) pPerfHud.Draw(pMetrics, pFrameTimeMetric);
+      ImGui::Render();
+    }
+
+    pMetrics.Record(pImGuiTimeMetric, SecondsSince(imgui_start));
+
+    pRenderResolution = pFrameBufferSize;
+
+    if (pDynamicResolutionEnabled) {
+      const glm::uvec2 scaled = glm::vec2(pFrameBufferSize) * pDynamicResolution.Scale();
+      pRenderResolution       = glm::max(scaled, glm::uvec2(1));
+    }
+
+    frame.render_resolution = pRenderResolution;
+    frame.offscreen         = pDynamicResolutionEnabled || pAntialiasing == Antialiasing::fxaa;
+    frame.max_scale         = pDynamicResolutionEnabled ? pDynamicResolution.Settings().max_scale : 1.f;
+  }
+
+  void Application::pSubmitWorld() {
+    Renderer::BeginDebugView(pRenderResolution);
+
+    {
+      PIXEL_PROFILE_SCOPE("pOnRender");
+      if (pOnRender() != rcode::ok) pThreadRunning = false;
+    }
+
+    Renderer::EndDebugView();
+  }
+
+  // The graphics thread's side of the frame, from the world pass to the swap. Replaying draws what the update thread
+  // recorded into the packet, otherwise pOnRender runs right here.
+  void Application::pDrawFrame(FramePacket& frame, bool replay, std::chrono::steady_clock::time_point work_start) {
+    if (frame.capture_stop) pCapture.Stop();
+    if (frame.capture_start) pCapture.Start(frame.capture, pFrameBufferSize);
+
+    if (pPacingRequested.exchange(false)) {
+      pPacing    = pPendingPacing;
+      pNextFrame = std::chrono::steady_clock::now();
+
+      pApplySwapInterval();
+    }
+
+    const auto render_start = std::chrono::steady_clock::now();
+
+    // Replaying only touches the cloned draw data, the update thread owns the ImGui context and the font atlas was
+    // built at launch
+    if (!replay) ImGui_ImplOpenGL3_NewFrame();
+    Renderer::gpu_timer.BeginFrame();
+
+    pBeginWorldPass(frame);
+
+    glClearColor(
+        pClearColor.x * pClearColor.w, pClearColor.y * pClearColor.w, pClearColor.z * pClearColor.w, pClearColor.w);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (replay) {
+      PIXEL_PROFILE_SCOPE("Replay");
+      frame.Replay(pGlBackend);
+
+    } else {
+      pSubmitWorld();
+    }
+
+    pEndWorldPass();
+
+    {
+      PIXEL_PROFILE_SCOPE("ImGui render");
+
+      ImDrawData* draw_data = replay ? frame.ImGuiDrawData() : ImGui::GetDrawData();
+
+      Renderer::gpu_timer.Begin(GpuPhase::imgui);
+      if (draw_data) ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+      Renderer::gpu_timer.End(GpuPhase::imgui);
+    }
+
+    Renderer::gpu_timer.EndFrame();
+
+    frame.render_time = SecondsSince(render_start);
+    frame.gpu         = Renderer::gpu_timer.Last();
+    frame.gpu_window  = Renderer::gpu_timer.Window();
+
+    if (pHeadless) pHeadlessTarget.Resolve();
+
+    if (pCapture.Active()) {
+      PIXEL_PROFILE_SCOPE("Frame capture");
+      pCapture.Capture(pHeadless ? pHeadlessTarget.getTextureFramebuffer() : 0);
+    }
+
+    // Time spent before the swap, which blocks on vsync and would otherwise hide how much budget is left
+    frame.work_time = SecondsSince(work_start);
+    frame.drawn     = true;
+
+    if (pPacing.target_fps > 0.f) {
+      PIXEL_PROFILE_SCOPE("Frame limiter");
+      pLimitFrameRate();
+    }
+
+    {
+      PIXEL_PROFILE_SCOPE("glfwSwapBuffers");
+
+      if (pHeadless) {
+        glFlush();
+
+      } else {
+        glfwSwapBuffers(pWindow);
+      }
+    }
+  }
+
+  void Application::pApplySwapInterval() {
+    int32_t interval = 0;
+
+    if (!pHeadless && pPacing.vsync == VSync::on) interval = 1;
+
+    // A negative interval asks for late swaps to happen right away, which needs one of the swap_control_tear extensions
+    if (!pHeadless && pPacing.vsync == VSync::adaptive) {
+      const bool tear = glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                        glfwExtensionSupported("GLX_EXT_swap_control_tear");
+
+      interval = tear ? -1 : 1;
+    }
+
+    glfwSwapInterval(interval);
+  }
+
+  // Deadlines advance by whole periods so the average rate holds even when a single wait overshoots. Falling more than
+  // a period behind restarts the schedule instead of rushing the frames after a stall to catch up.
+  void Application::pLimitFrameRate() {
+    using clock = std::chrono::steady_clock;
+
+    const std::chrono::duration<double> period_seconds(1. / pPacing.target_fps);
+    const std::chrono::duration<float>  spin_seconds(std::max(pPacing.spin_time, 0.f));
+
+    const auto period = std::chrono::duration_cast<clock::duration>(period_seconds);
+    const auto spin   = std::chrono::duration_cast<clock::duration>(spin_seconds);
+    const auto now    = clock::now();
+
+    pNextFrame += period;
+
+    if (now - pNextFrame > period) {
+      pNextFrame = now;
+      return;
+    }
+
+    if (pNextFrame - now > spin) std::this_thread::sleep_until(pNextFrame - spin);
+    while (clock::now() < pNextFrame) std::this_thread::yield();
+  }
+
+  // Takes in the timings of a drawn frame, on the thread that owns the metrics
+  void Application::pFinishFrame(FramePacket& frame) {
+    pMetrics.Record(pRenderTimeMetric, frame.render_time);
+    pMetrics.Record(pGpuTimeMetric, frame.gpu[GpuPhase::frame]);
+
+    Renderer::PublishGpuTimings(frame.gpu, frame.gpu_window);
+
+    if (pDynamicResolutionEnabled) pDynamicResolution.Update(frame.work_time, frame.gpu[GpuPhase::world]);
+    frame.drawn = false;
+  }
+
+  void Application::pEndFrame() {
+#ifdef PIXEL_METRICS
+    const Renderer::Stats& stats = Renderer::GetStats();
+
+    for (uint32_t i = 0; i < std::size(renderer_counters); i++) {
+      const uint32_t current  = stats.*renderer_counters[i].second;
+      const uint32_t previous = pLastStats.*renderer_counters[i].second;
+
+      // A smaller value means the application reset the stats since the last frame
+      pMetrics.Record(pFirstCounterMetric + i, (float)(current >= previous ? current - previous : current));
+    }
+
+    pLastStats = stats;
+#endif
+
+    if (pWantsToClose) {
+      pThreadRunning = false;
+      pWantsToClose  = false;
+    }
+
+    PIXEL_PROFILE_FRAME();
   }
 }
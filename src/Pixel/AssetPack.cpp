@@ -0,0 +1,171 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.hpp"
+#include "Pixel/AssetPack.hpp"
+#include "Pixel/TextureMips.hpp"
+#include "Util/Logger.hpp"
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace Pixel {
+  AssetPack::~AssetPack() { Close(); }
+
+  void AssetPack::Open(const std::string& filepath) {
+    Close();
+
+#ifdef _WIN32
+    pFileHandle = CreateFileA(
+        filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (pFileHandle == INVALID_HANDLE_VALUE) Logger::Die("Cannot open asset pack " + filepath);
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(pFileHandle, &size);
+    pSize = (size_t)size.QuadPart;
+
+    pMappingHandle = CreateFileMappingA(pFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!pMappingHandle) Logger::Die("Cannot map asset pack " + filepath);
+
+    pData = (const uint8_t*)MapViewOfFile(pMappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (!pData) Logger::Die("Cannot map asset pack " + filepath);
+#else
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) Logger::Die("Cannot open asset pack " + filepath);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) Logger::Die("Cannot stat asset pack " + filepath);
+    pSize = (size_t)info.st_size;
+
+    void* mapping = mmap(nullptr, pSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) Logger::Die("Cannot map asset pack " + filepath);
+    madvise(mapping, pSize, MADV_WILLNEED);
+
+    pData = (const uint8_t*)mapping;
+#endif
+
+    if (pSize < sizeof(PackHeader)) Logger::Die("Asset pack " + filepath + " is truncated");
+
+    const PackHeader* header = (const PackHeader*)pData;
+    if (header->magic != pack_magic) Logger::Die(filepath + " is not an asset pack");
+    if (header->version != pack_version) Logger::Die("Asset pack " + filepath + " has an unsupported version");
+
+    if (header->entry_offset > pSize || header->entry_count > (pSize - header->entry_offset) / sizeof(PackEntry)) {
+      Logger::Die("Asset pack " + filepath + " is truncated");
+    }
+
+    const PackEntry* entries = (const PackEntry*)(pData + header->entry_offset);
+    pEntries.reserve(header->entry_count);
+
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+      const PackEntry& entry = entries[i];
+
+      if (entry.blob_offset > pSize || entry.blob_count > (pSize - entry.blob_offset) / sizeof(PackBlob)) {
+        Logger::Die("Asset pack " + filepath + " is truncated");
+      }
+
+      pEntries[std::string_view(entry.name, strnlen(entry.name, sizeof(entry.name)))] = &entry;
+    }
+  }
+
+  void AssetPack::Close() {
+    if (!pData) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(pData);
+    CloseHandle(pMappingHandle);
+    CloseHandle(pFileHandle);
+#else
+    munmap((void*)pData, pSize);
+#endif
+
+    pData = nullptr;
+    pSize = 0;
+    pEntries.clear();
+  }
+
+  bool AssetPack::Contains(std::string_view name) const { return pEntries.contains(name); }
+
+  void AssetPack::LoadTexture(std::string_view name, Texture& texture) const {
+    const PackEntry& entry = pFind(name, PackEntryType::texture);
+    const PackBlob*  blobs = pBlobs(entry);
+
+    const glm::uvec2 size = {entry.width, entry.height};
+
+    if (size.x == 0 || size.y == 0) Logger::Die("Texture " + std::string(name) + " is empty");
+    if (entry.blob_count == 0) Logger::Die("Texture " + std::string(name) + " has no mip levels");
+    if (entry.blob_count > MipLevelCount(size)) {
+      Logger::Die("Texture " + std::string(name) + " has too many mip levels");
+    }
+
+    TextureLevel levels[32];
+
+    for (uint32_t i = 0; i < entry.blob_count; i++) {
+      // GL reads exactly one level's worth of bytes from each blob, so a short blob would read past the mapping
+      const uint64_t expected = TextureLevelSize(entry.format, TextureLevelDimensions(size, i));
+
+      if (blobs[i].size != expected || expected > UINT32_MAX) {
+        Logger::Die("Texture " + std::string(name) + " has a malformed mip level");
+      }
+
+      levels[i].data = pData + blobs[i].offset;
+      levels[i].size = (uint32_t)blobs[i].size;
+    }
+
+    texture.Load(size, entry.format, levels, entry.blob_count);
+  }
+
+  void AssetPack::LoadShader(std::string_view name, ShaderProgram& shader) const {
+    const PackEntry& entry = pFind(name, PackEntryType::shader);
+    const PackBlob*  blobs = pBlobs(entry);
+
+    if (entry.blob_count != 2) Logger::Die("Shader " + std::string(name) + " is malformed");
+
+    shader.LoadFromInlineCode(std::string_view((const char*)pData + blobs[0].offset, blobs[0].size),
+                              std::string_view((const char*)pData + blobs[1].offset, blobs[1].size));
+  }
+
+  const PackEntry& AssetPack::pFind(std::string_view name, PackEntryType type) const {
+    auto entry = pEntries.find(name);
+
+    if (entry == pEntries.end()) Logger::Die("Asset " + std::string(name) + " not found in asset pack");
+    if (entry->second->type != type) Logger::Die("Asset " + std::string(name) + " has the wrong type");
+
+    return *entry->second;
+  }
+
+  const PackBlob* AssetPack::pBlobs(const PackEntry& entry) const {
+    const PackBlob* blobs = (const PackBlob*)(pData + entry.blob_offset);
+
+    for (uint32_t i = 0; i < entry.blob_count; i++) {
+      if (blobs[i].offset > pSize || blobs[i].size > pSize - blobs[i].offset) {
+        Logger::Die("Asset pack blob out of bounds");
+      }
+    }
+
+    return blobs;
+  }
+}
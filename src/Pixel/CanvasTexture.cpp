@@ -0,0 +1,179 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/CanvasTexture.hpp"
+
+namespace Pixel {
+  void CanvasTexture::Create(const glm::uvec2& size, const glm::vec4& color) {
+    pSize = size;
+    pPixels.assign(size.x * size.y, PackColor(color));
+
+    pCreate(size, TextureFormat::rgba8, 1);
+    glTextureSubImage2D(pId, 0, 0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pPixels.data());
+
+    glCreateBuffers(2, pBuffers);
+    pDirtyCount = 0;
+  }
+
+  void CanvasTexture::Release() {
+    for (uint32_t i = 0; i < 2; i++) {
+      if (pFences[i]) glDeleteSync(pFences[i]);
+      pFences[i]         = nullptr;
+      pBufferCapacity[i] = 0;
+    }
+
+    if (pBuffers[0] != 0) glDeleteBuffers(2, pBuffers);
+    pBuffers[0] = pBuffers[1] = 0;
+
+    Texture::Release();
+  }
+
+  uint32_t CanvasTexture::PackColor(const glm::vec4& color) {
+    const glm::vec4 scaled = glm::clamp(color, 0.f, 1.f) * 255.f + .5f;
+
+    return (uint32_t)scaled.x | ((uint32_t)scaled.y << 8) | ((uint32_t)scaled.z << 16) | ((uint32_t)scaled.w << 24);
+  }
+
+  void CanvasTexture::SetPixel(uint32_t x, uint32_t y, uint32_t color) {
+    pPixels[y * pSize.x + x] = color;
+    MarkDirty({x, y}, {1, 1});
+  }
+
+  void CanvasTexture::SetPixel(uint32_t x, uint32_t y, const glm::vec4& color) { SetPixel(x, y, PackColor(color)); }
+
+  void CanvasTexture::Fill(const glm::uvec2& position, const glm::uvec2& size, uint32_t color) {
+    // Clip against the canvas first so rectangles crossing an edge never write past the pixel buffer
+    const glm::uvec2 min = glm::min(position, pSize);
+    const glm::uvec2 max = glm::min(position + glm::min(size, pSize - min), pSize);
+    if (min.x >= max.x || min.y >= max.y) return;
+
+    for (uint32_t y = min.y; y < max.y; y++) {
+      std::fill_n(&pPixels[y * pSize.x + min.x], max.x - min.x, color);
+    }
+
+    MarkDirty(min, max - min);
+  }
+
+  void CanvasTexture::MarkDirty(const glm::uvec2& position, const glm::uvec2& size) {
+    DirtyRect rect {position, glm::min(position + size, pSize)};
+    if (rect.min.x >= rect.max.x || rect.min.y >= rect.max.y) return;
+
+    // Absorb every rectangle the new one touches, repeating since the union can reach rectangles that did not touch
+    // the original
+    for (bool merged = true; merged;) {
+      merged = false;
+
+      for (uint32_t i = 0; i < pDirtyCount; i++) {
+        const DirtyRect& other = pDirty[i];
+
+        if (rect.min.x <= other.max.x && other.min.x <= rect.max.x && rect.min.y <= other.max.y &&
+            other.min.y <= rect.max.y) {
+          rect.min = glm::min(rect.min, other.min);
+          rect.max = glm::max(rect.max, other.max);
+
+          pDirty[i] = pDirty[--pDirtyCount];
+          merged    = true;
+          break;
+        }
+      }
+    }
+
+    if (pDirtyCount == pMaxDirtyRects) {
+      for (uint32_t i = 0; i < pDirtyCount; i++) {
+        rect.min = glm::min(rect.min, pDirty[i].min);
+        rect.max = glm::max(rect.max, pDirty[i].max);
+      }
+
+      pDirtyCount = 0;
+    }
+
+    pDirty[pDirtyCount++] = rect;
+  }
+
+  void CanvasTexture::MarkAllDirty() {
+    pDirtyCount = 0;
+    MarkDirty({0, 0}, pSize);
+  }
+
+  void CanvasTexture::Upload() {
+    pUploadedBytes = 0;
+    if (pDirtyCount == 0) return;
+
+    for (uint32_t i = 0; i < pDirtyCount; i++) {
+      const glm::uvec2 size = pDirty[i].max - pDirty[i].min;
+      pUploadedBytes += size.x * size.y * sizeof(uint32_t);
+    }
+
+    pBufferIndex        = (pBufferIndex + 1) % 2;
+    const GLuint buffer = pBuffers[pBufferIndex];
+
+    // The buffer was last used two uploads ago, so this wait normally returns immediately
+    if (pFences[pBufferIndex]) {
+      glClientWaitSync(pFences[pBufferIndex], GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+      glDeleteSync(pFences[pBufferIndex]);
+      pFences[pBufferIndex] = nullptr;
+    }
+
+    if (pUploadedBytes > pBufferCapacity[pBufferIndex]) {
+      pBufferCapacity[pBufferIndex] = pUploadedBytes;
+      glNamedBufferData(buffer, pUploadedBytes, nullptr, GL_STREAM_DRAW);
+    }
+
+    auto* mapping = (uint8_t*)glMapNamedBufferRange(
+        buffer, 0, pUploadedBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+    uint64_t offsets[pMaxDirtyRects];
+    uint64_t offset = 0;
+
+    for (uint32_t i = 0; i < pDirtyCount; i++) {
+      const DirtyRect& rect = pDirty[i];
+      const uint32_t   row  = (rect.max.x - rect.min.x) * sizeof(uint32_t);
+
+      offsets[i] = offset;
+
+      for (uint32_t y = rect.min.y; y < rect.max.y; y++) {
+        std::memcpy(mapping + offset, &pPixels[y * pSize.x + rect.min.x], row);
+        offset += row;
+      }
+    }
+
+    glUnmapNamedBuffer(buffer);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    for (uint32_t i = 0; i < pDirtyCount; i++) {
+      const DirtyRect& rect = pDirty[i];
+
+      glTextureSubImage2D(pId,
+                          0,
+                          rect.min.x,
+                          rect.min.y,
+                          rect.max.x - rect.min.x,
+                          rect.max.y - rect.min.y,
+                          GL_RGBA,
+                          GL_UNSIGNED_BYTE,
+                          (const void*)offsets[i]);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    pFences[pBufferIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pDirtyCount           = 0;
+  }
+}
@@ -0,0 +1,434 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/CommandRecording.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Util/Logger.hpp"
+
+namespace Pixel {
+  void CommandRecorder::Start(const std::filesystem::path& filepath, const glm::uvec2& size, uint32_t frames) {
+    Stop();
+
+    pFile.open(filepath, std::ios::binary | std::ios::trunc);
+
+    if (!pFile) {
+      Logger::Info("Cannot write command recording " + filepath.string());
+      return;
+    }
+
+    RecordingHeader header;
+    header.width  = size.x;
+    header.height = size.y;
+    pFile.write((const char*)&header, sizeof(header));
+
+    pBuffer.clear();
+    pBuffer.reserve(pFlushSize + 4096);
+
+    pBytes        = sizeof(header);
+    pFrames       = 0;
+    pMaxFrames    = frames;
+    pTextureCount = 0;
+    pActive       = true;
+  }
+
+  void CommandRecorder::Stop() {
+    if (!pActive) return;
+
+    pFlush();
+
+    RecordingHeader header;
+    header.frame_count = pFrames;
+
+    // Only the frame count is unknown until now, the size was written by Start
+    pFile.seekp(offsetof(RecordingHeader, frame_count));
+    pFile.write((const char*)&header.frame_count, sizeof(header.frame_count));
+    pFile.close();
+
+    pTextures.clear();
+    pTargets.clear();
+    pActive = false;
+  }
+
+  void CommandRecorder::NewFrame() {
+    if (!pActive) return;
+
+    if (pMaxFrames != 0 && pFrames == pMaxFrames) {
+      Stop();
+      return;
+    }
+
+    pFrames++;
+    Record(RenderCommand::new_frame);
+  }
+
+  void CommandRecorder::pWrite(const Texture& texture) {
+    if (texture.getId() == Renderer::white_texture.getId()) {
+      pWriteRaw(0u);
+      return;
+    }
+
+    const auto [reference, added] = pTextures.try_emplace(texture.getId(), pTextureCount + 1);
+
+    if (!added) {
+      pWriteRaw(reference->second);
+      return;
+    }
+
+    pTextureCount++;
+    pWriteRaw(pNewTexture);
+    pWriteRaw(texture.MemoryBytes());
+  }
+
+  void CommandRecorder::pWrite(const RenderTarget& target) {
+    const uint32_t index = pTargets.try_emplace(&target, (uint32_t)pTargets.size()).first->second;
+
+    // Resizing gives the target a new texture, so the name is mapped again on every bind
+    if (target.getId() != 0) pTextures[target.getId()] = pTargetBit | index;
+
+    pWriteRaw(index);
+    pWriteRaw(target.Size());
+    pWriteRaw((uint32_t)target.InternalFormat());
+    pWriteRaw(target.Samples());
+  }
+
+  void CommandRecorder::pFlush() {
+    pFile.write((const char*)pBuffer.data(), pBuffer.size());
+
+    pBytes += pBuffer.size();
+    pBuffer.clear();
+  }
+
+  void CommandPlayer::Open(const std::string& filepath, bool gpu_resources) {
+    Release();
+
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) Logger::Die("Cannot open command recording " + filepath);
+
+    pData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (pData.size() < sizeof(RecordingHeader)) Logger::Die("Command recording " + filepath + " is truncated");
+
+    RecordingHeader header;
+    std::memcpy(&header, pData.data(), sizeof(header));
+
+    if (header.magic != recording_magic) Logger::Die(filepath + " is not a command recording");
+    if (header.version != recording_version)
+      Logger::Die("Command recording " + filepath + " has an unsupported version");
+
+    pSize         = {header.width, header.height};
+    pFrameCount   = header.frame_count;
+    pStart        = sizeof(header);
+    pCursor       = pStart;
+    pGpuResources = gpu_resources;
+  }
+
+  void CommandPlayer::Release() {
+    if (pGpuResources) {
+      for (auto& texture : pTextures) texture.Release();
+      for (auto& target : pTargets) target.Release();
+    }
+
+    pTextures.clear();
+    pTargets.clear();
+    pData.clear();
+
+    pCursor = pStart = 0;
+  }
+
+  bool CommandPlayer::PlayFrame() {
+    if (pCursor >= pData.size()) return false;
+
+    // A recorder started mid-frame leaves that frame's tail before the first marker, which plays as a frame of its own
+    if ((RenderCommand)pData[pCursor] == RenderCommand::new_frame) pCursor++;
+
+    while (pCursor < pData.size() && (RenderCommand)pData[pCursor] != RenderCommand::new_frame) {
+      pPlay((RenderCommand)pData[pCursor++]);
+    }
+
+    return true;
+  }
+
+  void CommandPlayer::Rewind() { pCursor = pStart; }
+
+  void CommandPlayer::pReadBytes(void* value, size_t size) {
+    if (pCursor + size > pData.size()) Logger::Die("Command recording is truncated");
+
+    std::memcpy(value, &pData[pCursor], size);
+    pCursor += size;
+  }
+
+  const Texture& CommandPlayer::pReadTexture() {
+    const uint32_t reference = pRead<uint32_t>();
+
+    if (reference == 0) return Renderer::white_texture;
+
+    if (reference & CommandRecorder::pTargetBit) {
+      const uint32_t index = reference & ~CommandRecorder::pTargetBit;
+      if (index >= pTargets.size()) Logger::Die("Command recording references an unknown render target");
+
+      return pTargets[index];
+    }
+
+    if (reference != CommandRecorder::pNewTexture) {
+      if (reference > pTextures.size()) Logger::Die("Command recording references an unknown texture");
+      return pTextures[reference - 1];
+    }
+
+    const uint64_t bytes   = pRead<uint64_t>();
+    Texture&       texture = pTextures.emplace_back();
+
+    if (!pGpuResources) return texture;
+
+    // A square RGBA8 stand-in with about the same footprint, flat colored so every texture stays distinguishable
+    const uint32_t side    = std::clamp((uint32_t)std::ceil(std::sqrt(bytes / 4.)), 1u, 4096u);
+    const uint32_t index   = (uint32_t)pTextures.size();
+    const uint8_t  rgba[4] = {(uint8_t)(index * 97), (uint8_t)(index * 57), (uint8_t)(index * 31), 255};
+
+    std::vector<uint8_t> pixels((size_t)side * side * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4) std::memcpy(&pixels[i], rgba, 4);
+
+    const TextureLevel level = {pixels.data(), (uint32_t)pixels.size()};
+    texture.Load({side, side}, TextureFormat::rgba8, &level, 1);
+
+    return texture;
+  }
+
+  RenderTarget& CommandPlayer::pReadTarget() {
+    const uint32_t   index   = pRead<uint32_t>();
+    const glm::uvec2 size    = pRead<glm::uvec2>();
+    const uint32_t   format  = pRead<uint32_t>();
+    const uint32_t   samples = pRead<uint32_t>();
+
+    if (index > pTargets.size()) Logger::Die("Command recording references an unknown render target");
+
+    if (index == pTargets.size()) {
+      RenderTarget& target = pTargets.emplace_back();
+      if (pGpuResources) target.Create(size, format, samples);
+
+      return target;
+    }
+
+    RenderTarget& target = pTargets[index];
+    if (pGpuResources) target.Resize(size);
+
+    return target;
+  }
+
+  // Arguments are read into locals first, the order function arguments are evaluated in is unspecified
+  void CommandPlayer::pPlay(RenderCommand command) {
+    switch (command) {
+      case RenderCommand::begin_batch:
+        Renderer::BeginBatch();
+        break;
+
+      case RenderCommand::end_batch:
+        Renderer::EndBatch();
+        break;
+
+      case RenderCommand::flush_batch:
+        Renderer::FlushBatch();
+        break;
+
+      case RenderCommand::begin_target: {
+        RenderTarget&   target      = pReadTarget();
+        const bool      clear       = pRead<uint8_t>() != 0;
+        const glm::vec4 clear_color = pRead<glm::vec4>();
+
+        Renderer::BeginTarget(target, clear, clear_color);
+        break;
+      }
+
+      case RenderCommand::end_target:
+        Renderer::EndTarget();
+        break;
+
+      case RenderCommand::draw_quad: {
+        const glm::vec2 position = pRead<glm::vec2>();
+        const glm::vec2 size     = pRead<glm::vec2>();
+        const glm::vec4 color    = pRead<glm::vec4>();
+        const Texture&  texture  = pReadTexture();
+
+        Renderer::DrawQuad(position, size, color, texture);
+        break;
+      }
+
+      case RenderCommand::draw_tri: {
+        const glm::vec2 v1    = pRead<glm::vec2>();
+        const glm::vec2 v2    = pRead<glm::vec2>();
+        const glm::vec2 v3    = pRead<glm::vec2>();
+        const glm::vec4 color = pRead<glm::vec4>();
+
+        Renderer::DrawTri(v1, v2, v3, color);
+        break;
+      }
+
+      case RenderCommand::draw_circle: {
+        const glm::vec2 position = pRead<glm::vec2>();
+        const float     radius   = pRead<float>();
+        const uint32_t  segments = pRead<uint32_t>();
+        const glm::vec4 color    = pRead<glm::vec4>();
+
+        Renderer::DrawCircle(position, radius, segments, color);
+        break;
+      }
+
+      case RenderCommand::draw_line: {
+        const glm::vec2 pos1  = pRead<glm::vec2>();
+        const glm::vec2 pos2  = pRead<glm::vec2>();
+        const glm::vec4 color = pRead<glm::vec4>();
+
+        Renderer::DrawLine(pos1, pos2, color);
+        break;
+      }
+
+      case RenderCommand::draw_wide_line: {
+        const glm::vec2 pos1  = pRead<glm::vec2>();
+        const glm::vec2 pos2  = pRead<glm::vec2>();
+        const float     width = pRead<float>();
+        const glm::vec4 color = pRead<glm::vec4>();
+
+        Renderer::DrawLine(pos1, pos2, width, color);
+        break;
+      }
+
+      case RenderCommand::outline_quad: {
+        const glm::vec2 position = pRead<glm::vec2>();
+        const glm::vec2 size     = pRead<glm::vec2>();
+        const glm::vec4 color    = pRead<glm::vec4>();
+
+        Renderer::OutlineQuad(position, size, color);
+        break;
+      }
+
+      case RenderCommand::outline_tri: {
+        const glm::vec2 v1    = pRead<glm::vec2>();
+        const glm::vec2 v2    = pRead<glm::vec2>();
+        const glm::vec2 v3    = pRead<glm::vec2>();
+        const float     width = pRead<float>();
+        const glm::vec4 color = pRead<glm::vec4>();
+
+        Renderer::OutlineTri(v1, v2, v3, width, color);
+        break;
+      }
+
+      case RenderCommand::border_tri: {
+        const glm::vec2 v1           = pRead<glm::vec2>();
+        const glm::vec2 v2           = pRead<glm::vec2>();
+        const glm::vec2 v3           = pRead<glm::vec2>();
+        const float     width        = pRead<float>();
+        const glm::vec4 inner_color  = pRead<glm::vec4>();
+        const glm::vec4 outter_color = pRead<glm::vec4>();
+
+        Renderer::BorderTri(v1, v2, v3, width, inner_color, outter_color);
+        break;
+      }
+
+      case RenderCommand::outline_circle: {
+        const glm::vec2 position = pRead<glm::vec2>();
+        const float     radius   = pRead<float>();
+        const uint32_t  segments = pRead<uint32_t>();
+        const float     width    = pRead<float>();
+        const glm::vec4 color    = pRead<glm::vec4>();
+
+        Renderer::OutlineCircle(position, radius, segments, width, color);
+        break;
+      }
+
+      case RenderCommand::border_circle: {
+        const glm::vec2 position     = pRead<glm::vec2>();
+        const float     radius       = pRead<float>();
+        const uint32_t  segments     = pRead<uint32_t>();
+        const float     width        = pRead<float>();
+        const glm::vec4 inner_color  = pRead<glm::vec4>();
+        const glm::vec4 outter_color = pRead<glm::vec4>();
+
+        Renderer::BorderCircle(position, radius, segments, width, inner_color, outter_color);
+        break;
+      }
+
+      case RenderCommand::border_semicircle: {
+        const glm::vec2 position     = pRead<glm::vec2>();
+        const float     radius       = pRead<float>();
+        const float     start_angle  = pRead<float>();
+        const float     end_angle    = pRead<float>();
+        const uint32_t  segments     = pRead<uint32_t>();
+        const float     width        = pRead<float>();
+        const glm::vec4 inner_color  = pRead<glm::vec4>();
+        const glm::vec4 outter_color = pRead<glm::vec4>();
+
+        Renderer::BorderSemicircle(
+            position, radius, start_angle, end_angle, segments, width, inner_color, outter_color);
+        break;
+      }
+
+      case RenderCommand::border_semicircle_custom_center_inside:
+      case RenderCommand::border_semicircle_custom_center_outside: {
+        const glm::vec2 position     = pRead<glm::vec2>();
+        const glm::vec2 center       = pRead<glm::vec2>();
+        const float     radius       = pRead<float>();
+        const float     start_angle  = pRead<float>();
+        const float     end_angle    = pRead<float>();
+        const uint32_t  segments     = pRead<uint32_t>();
+        const float     width        = pRead<float>();
+        const glm::vec4 inner_color  = pRead<glm::vec4>();
+        const glm::vec4 outter_color = pRead<glm::vec4>();
+
+        if (command == RenderCommand::border_semicircle_custom_center_inside) {
+          Renderer::BorderSemicircleCustomCenterInside(
+              position, center, radius, start_angle, end_angle, segments, width, inner_color, outter_color);
+
+        } else {
+          Renderer::BorderSemicircleCustomCenterOutside(
+              position, center, radius, start_angle, end_angle, segments, width, inner_color, outter_color);
+        }
+
+        break;
+      }
+
+      case RenderCommand::set_view_projection:
+        Renderer::SetViewProjection(pRead<glm::mat4>());
+        break;
+
+      case RenderCommand::set_transform:
+        Renderer::SetTransform(pRead<glm::vec3>());
+        break;
+
+      case RenderCommand::set_view_projection_override:
+        Renderer::SetViewProjectionOverride(pRead<glm::mat4>());
+        break;
+
+      case RenderCommand::clear_view_projection_override:
+        Renderer::ClearViewProjectionOverride();
+        break;
+
+      case RenderCommand::set_debug_view:
+        Renderer::SetDebugView((DebugView)pRead<uint8_t>());
+        break;
+
+      case RenderCommand::begin_debug_view:
+        Renderer::BeginDebugView(pRead<glm::uvec2>());
+        break;
+
+      case RenderCommand::end_debug_view:
+        Renderer::EndDebugView();
+        break;
+
+      default:
+        Logger::Die("Command recording is malformed");
+    }
+  }
+}
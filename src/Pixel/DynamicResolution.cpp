@@ -0,0 +1,57 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/DynamicResolution.hpp"
+
+namespace Pixel {
+  void DynamicResolution::Configure(const DynamicResolutionSettings& settings) {
+    pSettings     = settings;
+    pScale        = settings.max_scale;
+    pFrameTime    = settings.target_frame_time;
+    pCooldown     = 0;
+    pLastDecision = ScaleDecision::hold;
+  }
+
+  ScaleDecision DynamicResolution::Update(float cpu_frame_time, float gpu_frame_time) {
+    const float sample = std::max(cpu_frame_time, gpu_frame_time);
+    pFrameTime += (sample - pFrameTime) * pSettings.smoothing;
+
+    pLastDecision = ScaleDecision::hold;
+
+    if (pCooldown > 0) {
+      pCooldown--;
+      return pLastDecision;
+    }
+
+    if (pFrameTime > pSettings.target_frame_time && pScale > pSettings.min_scale) {
+      const float ideal = pScale * std::sqrt(pSettings.target_frame_time / pFrameTime);
+
+      pScale        = std::max(std::max(ideal, pScale - pSettings.step), pSettings.min_scale);
+      pLastDecision = ScaleDecision::decrease;
+      pDecreases++;
+
+    } else if (pFrameTime < pSettings.target_frame_time * pSettings.headroom && pScale < pSettings.max_scale) {
+      pScale        = std::min(pScale + pSettings.step, pSettings.max_scale);
+      pLastDecision = ScaleDecision::increase;
+      pIncreases++;
+    }
+
+    if (pLastDecision != ScaleDecision::hold) pCooldown = pSettings.cooldown_frames;
+    return pLastDecision;
+  }
+}
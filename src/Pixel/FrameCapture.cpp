@@ -0,0 +1,302 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/FrameCapture.hpp"
+#include "Util/Logger.hpp"
+#include "Util/PngWriter.hpp"
+#include "Util/Profiler.hpp"
+
+#ifdef _WIN32
+  #define popen  _popen
+  #define pclose _pclose
+#endif
+
+namespace Pixel {
+  static void ConvertRgb(const uint8_t* rgba, const glm::uvec2& size, uint8_t* out) {
+    // The readback is bottom row first, encoders expect the top row first
+    for (uint32_t y = 0; y < size.y; y++) {
+      const uint8_t* row = rgba + (size_t)(size.y - 1 - y) * size.x * 4;
+
+      for (uint32_t x = 0; x < size.x; x++) {
+        *out++ = row[x * 4 + 0];
+        *out++ = row[x * 4 + 1];
+        *out++ = row[x * 4 + 2];
+      }
+    }
+  }
+
+  static void ConvertYuv420(const uint8_t* rgba, const glm::uvec2& size, uint8_t* out) {
+    const glm::uvec2 chroma = (size + 1u) / 2u;
+
+    uint8_t* y_plane = out;
+    uint8_t* u_plane = y_plane + (size_t)size.x * size.y;
+    uint8_t* v_plane = u_plane + (size_t)chroma.x * chroma.y;
+
+    const auto pixel = [&](uint32_t x, uint32_t y) {
+      return rgba + ((size_t)(size.y - 1 - std::min(y, size.y - 1)) * size.x + std::min(x, size.x - 1)) * 4;
+    };
+
+    for (uint32_t y = 0; y < size.y; y++) {
+      for (uint32_t x = 0; x < size.x; x++) {
+        const uint8_t* p = pixel(x, y);
+        *y_plane++       = (uint8_t)(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+      }
+    }
+
+    for (uint32_t y = 0; y < chroma.y; y++) {
+      for (uint32_t x = 0; x < chroma.x; x++) {
+        int32_t r = 0, g = 0, b = 0;
+
+        for (uint32_t i = 0; i < 4; i++) {
+          const uint8_t* p = pixel(x * 2 + (i & 1), y * 2 + (i >> 1));
+          r += p[0];
+          g += p[1];
+          b += p[2];
+        }
+
+        r = (r + 2) / 4;
+        g = (g + 2) / 4;
+        b = (b + 2) / 4;
+
+        *u_plane++ = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        *v_plane++ = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+      }
+    }
+  }
+
+  void FrameCapture::Start(const CaptureSettings& settings, const glm::uvec2& size) {
+    if (pActive) Stop();
+
+    pSettings      = settings;
+    pSize          = glm::max(size, glm::uvec2 {1, 1});
+    pFrameBytes    = (size_t)pSize.x * pSize.y * 4;
+    pFrameIndex    = 0;
+    pFramesWritten = 0;
+    pNextWrite     = 0;
+    pStopping      = false;
+
+    if (settings.format == CaptureFormat::png) {
+      std::filesystem::create_directories(settings.output);
+
+    } else if (settings.format == CaptureFormat::callback) {
+      if (!settings.callback) Logger::Die("Callback capture started without a callback");
+
+    } else if (!settings.command.empty()) {
+      pStream = popen(settings.command.c_str(), "w");
+      if (!pStream) Logger::Die("Cannot start capture command " + settings.command);
+
+    } else {
+      pStream = std::fopen(settings.output.string().c_str(), "wb");
+      if (!pStream) Logger::Die("Cannot open capture output " + settings.output.string());
+    }
+
+    for (auto& slot : pSlots) {
+      glCreateBuffers(1, &slot.buffer);
+      glNamedBufferStorage(slot.buffer, pFrameBytes, nullptr, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT);
+
+      slot.mapping =
+          (uint8_t*)glMapNamedBufferRange(slot.buffer, 0, pFrameBytes, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT);
+    }
+
+    // One frame in flight per worker plus one being filled by the graphics thread keeps every worker busy
+    const uint32_t workers = std::max(settings.workers, 1u);
+
+    pBuffers.resize(workers + 1);
+    pFreeBuffers.clear();
+
+    for (uint32_t i = 0; i < pBuffers.size(); i++) {
+      pBuffers[i].resize(pFrameBytes);
+      pFreeBuffers.push_back(i);
+    }
+
+    for (uint32_t i = 0; i < workers; i++) {
+      pWorkers.emplace_back(&FrameCapture::pWorker, this);
+    }
+
+    pActive = true;
+  }
+
+  void FrameCapture::Capture(GLuint framebuffer) {
+    if (!pActive) return;
+
+    Slot& slot = pSlots[pFrameIndex % pRingSize];
+
+    GLint read_framebuffer;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_framebuffer);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(framebuffer == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, pSize.x, pSize.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, read_framebuffer);
+
+    // The mapping is not coherent, the barrier makes the copy visible to the CPU once the fence signals
+    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = pFrameIndex++;
+
+    // Collect frame N - 2, which has had two frames worth of GPU time to land
+    Slot& oldest = pSlots[pFrameIndex % pRingSize];
+    if (oldest.fence) pRetire(oldest);
+  }
+
+  void FrameCapture::Stop() {
+    if (!pActive) return;
+
+    for (uint64_t i = 0; i < pRingSize; i++) {
+      Slot& slot = pSlots[(pFrameIndex + i) % pRingSize];
+      if (slot.fence) pRetire(slot);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(pMutex);
+      pStopping = true;
+    }
+
+    pJobReady.notify_all();
+
+    for (auto& worker : pWorkers) worker.join();
+    pWorkers.clear();
+
+    if (pStream) {
+      if (pSettings.command.empty()) {
+        std::fclose(pStream);
+
+      } else {
+        pclose(pStream);
+      }
+    }
+
+    pStream = nullptr;
+
+    for (auto& slot : pSlots) {
+      glUnmapNamedBuffer(slot.buffer);
+      glDeleteBuffers(1, &slot.buffer);
+      slot = {};
+    }
+
+    pBuffers     = {};
+    pFreeBuffers = {};
+    pActive      = false;
+  }
+
+  void FrameCapture::pRetire(Slot& slot) {
+    glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    uint32_t buffer;
+
+    {
+      std::unique_lock<std::mutex> lock(pMutex);
+      pBufferFree.wait(lock, [this] { return !pFreeBuffers.empty(); });
+
+      buffer = pFreeBuffers.back();
+      pFreeBuffers.pop_back();
+    }
+
+    std::memcpy(pBuffers[buffer].data(), slot.mapping, pFrameBytes);
+
+    {
+      std::lock_guard<std::mutex> lock(pMutex);
+      pJobs.push_back({slot.frame, buffer});
+    }
+
+    pJobReady.notify_one();
+  }
+
+  void FrameCapture::pWorker() {
+    PIXEL_PROFILE_THREAD("Capture worker");
+
+    std::vector<uint8_t> converted;
+    PngWriter            png;
+
+    while (true) {
+      Job job;
+
+      {
+        std::unique_lock<std::mutex> lock(pMutex);
+        pJobReady.wait(lock, [this] { return pStopping || !pJobs.empty(); });
+        if (pJobs.empty()) return;
+
+        job = pJobs.front();
+        pJobs.pop_front();
+      }
+
+      PIXEL_PROFILE_SCOPE("Encode frame");
+      const uint8_t* pixels = pBuffers[job.buffer].data();
+
+      switch (pSettings.format) {
+        case CaptureFormat::png: {
+          char name[32];
+          std::snprintf(name, sizeof(name), "frame_%06llu.png", (unsigned long long)job.frame);
+
+          if (!png.Open(pSettings.output / name, pSize, 4)) {
+            Logger::Info("Cannot write captured frame " + std::string(name));
+            break;
+          }
+
+          for (uint32_t y = pSize.y; y > 0; y--) png.WriteRow(pixels + (size_t)(y - 1) * pSize.x * 4);
+          png.Close();
+          break;
+        }
+
+        case CaptureFormat::rgb:
+          converted.resize((size_t)pSize.x * pSize.y * 3);
+          ConvertRgb(pixels, pSize, converted.data());
+          break;
+
+        case CaptureFormat::yuv420: {
+          const glm::uvec2 chroma = (pSize + 1u) / 2u;
+
+          converted.resize((size_t)pSize.x * pSize.y + (size_t)chroma.x * chroma.y * 2);
+          ConvertYuv420(pixels, pSize, converted.data());
+          break;
+        }
+
+        case CaptureFormat::callback:
+          pSettings.callback(job.frame, pixels, pSize);
+          break;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(pMutex);
+        pFreeBuffers.push_back(job.buffer);
+      }
+
+      pBufferFree.notify_one();
+
+      if (pStream) pWriteOrdered(job.frame, converted.data(), converted.size());
+      pFramesWritten++;
+    }
+  }
+
+  void FrameCapture::pWriteOrdered(uint64_t frame, const uint8_t* data, size_t size) {
+    std::unique_lock<std::mutex> lock(pStreamMutex);
+    pStreamTurn.wait(lock, [&] { return pNextWrite == frame; });
+
+    std::fwrite(data, 1, size, pStream);
+
+    pNextWrite++;
+    pStreamTurn.notify_all();
+  }
+}
@@ -0,0 +1,298 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.hpp"
+#include "Pixel/FramePacket.hpp"
+
+namespace Pixel {
+  FramePacket::~FramePacket() { pReleaseImGui(); }
+
+  void FramePacket::Reset() {
+    pEntries.clear();
+    pVertices.clear();
+    pIndices.clear();
+    pMatrices.clear();
+    pTextures.clear();
+
+    pReleaseImGui();
+  }
+
+  void FramePacket::Replay(RenderBackend& backend) const {
+    for (const Entry& entry : pEntries) {
+      switch (entry.command) {
+        case Command::upload:
+          backend.Upload({entry.lines,
+                          pVertices.data() + entry.first,
+                          entry.count,
+                          pIndices.data() + entry.first_index,
+                          entry.index_count,
+                          &pMatrices[entry.matrix],
+                          &pMatrices[entry.matrix + 1]});
+          break;
+
+        case Command::draw: {
+          BatchDraw draw     = {};
+          draw.lines         = entry.lines;
+          draw.index_count   = entry.index_count;
+          draw.textures      = pTextures.data() + entry.first;
+          draw.texture_count = entry.count;
+          draw.debug_view    = entry.debug_view;
+          draw.debug_color   = entry.debug_color;
+
+          backend.Draw(draw);
+          break;
+        }
+
+        case Command::begin_target:
+          backend.BeginTarget(*entry.target, entry.clear, entry.clear_color);
+          break;
+
+        case Command::end_target:
+          backend.EndTarget(*entry.target);
+          break;
+
+        case Command::begin_overdraw:
+          backend.BeginOverdraw(entry.size);
+          break;
+
+        case Command::end_overdraw:
+          backend.EndOverdraw();
+          break;
+      }
+    }
+  }
+
+  void FramePacket::Upload(const BatchUpload& batch) {
+    Entry entry       = {};
+    entry.command     = Command::upload;
+    entry.lines       = batch.lines;
+    entry.first       = (uint32_t)pVertices.size();
+    entry.count       = batch.vertex_count;
+    entry.first_index = (uint32_t)pIndices.size();
+    entry.index_count = batch.index_count;
+    entry.matrix      = (uint32_t)pMatrices.size();
+
+    pVertices.insert(pVertices.end(), batch.vertices, batch.vertices + batch.vertex_count);
+    pIndices.insert(pIndices.end(), batch.indices, batch.indices + batch.index_count);
+    pMatrices.push_back(*batch.view_projection);
+    pMatrices.push_back(*batch.transform);
+
+    pEntries.push_back(entry);
+  }
+
+  void FramePacket::Draw(const BatchDraw& draw) {
+    Entry entry       = {};
+    entry.command     = Command::draw;
+    entry.lines       = draw.lines;
+    entry.first       = (uint32_t)pTextures.size();
+    entry.count       = draw.texture_count;
+    entry.index_count = draw.index_count;
+    entry.debug_view  = draw.debug_view;
+    entry.debug_color = draw.debug_color;
+
+    pTextures.insert(pTextures.end(), draw.textures, draw.textures + draw.texture_count);
+    pEntries.push_back(entry);
+  }
+
+  void FramePacket::BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) {
+    Entry entry       = {};
+    entry.command     = Command::begin_target;
+    entry.target      = &target;
+    entry.clear       = clear;
+    entry.clear_color = clear_color;
+
+    pEntries.push_back(entry);
+  }
+
+  void FramePacket::EndTarget(RenderTarget& target) {
+    Entry entry   = {};
+    entry.command = Command::end_target;
+    entry.target  = &target;
+
+    pEntries.push_back(entry);
+  }
+
+  void FramePacket::BeginOverdraw(const glm::uvec2& size) {
+    Entry entry   = {};
+    entry.command = Command::begin_overdraw;
+    entry.size    = size;
+
+    pEntries.push_back(entry);
+  }
+
+  void FramePacket::EndOverdraw() {
+    Entry entry   = {};
+    entry.command = Command::end_overdraw;
+
+    pEntries.push_back(entry);
+  }
+
+  // ImGui reuses its draw lists every frame, so the packet keeps clones of them until it is drawn. CmdLists became an
+  // owned ImVector in 1.89.8, before that it points at an array the copy has to provide itself.
+  void FramePacket::SetImGuiDrawData(const ImDrawData* draw_data) {
+    pReleaseImGui();
+    if (!draw_data || !draw_data->Valid) return;
+
+    pImGuiData = *draw_data;
+
+#if IMGUI_VERSION_NUM >= 18980
+    for (ImDrawList*& list : pImGuiData.CmdLists) list = list->CloneOutput();
+#else
+    for (int i = 0; i < draw_data->CmdListsCount; i++) pImGuiLists.push_back(draw_data->CmdLists[i]->CloneOutput());
+    pImGuiData.CmdLists = pImGuiLists.data();
+#endif
+  }
+
+  void FramePacket::pReleaseImGui() {
+#if IMGUI_VERSION_NUM >= 18980
+    for (ImDrawList* list : pImGuiData.CmdLists) IM_DELETE(list);
+#else
+    for (ImDrawList* list : pImGuiLists) IM_DELETE(list);
+    pImGuiLists.clear();
+#endif
+
+    pImGuiData = ImDrawData();
+  }
+
+  void PacketBackend::Upload(const BatchUpload& batch) {
+    if (pPacket) {
+      pPacket->Upload(batch);
+
+    } else {
+      pTarget->Upload(batch);
+    }
+  }
+
+  void PacketBackend::Draw(const BatchDraw& draw) {
+    if (pPacket) {
+      pPacket->Draw(draw);
+
+    } else {
+      pTarget->Draw(draw);
+    }
+  }
+
+  void PacketBackend::BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) {
+    if (pPacket) {
+      pPacket->BeginTarget(target, clear, clear_color);
+
+    } else {
+      pTarget->BeginTarget(target, clear, clear_color);
+    }
+  }
+
+  void PacketBackend::EndTarget(RenderTarget& target) {
+    if (pPacket) {
+      pPacket->EndTarget(target);
+
+    } else {
+      pTarget->EndTarget(target);
+    }
+  }
+
+  void PacketBackend::BeginOverdraw(const glm::uvec2& size) {
+    if (pPacket) {
+      pPacket->BeginOverdraw(size);
+
+    } else {
+      pTarget->BeginOverdraw(size);
+    }
+  }
+
+  void PacketBackend::EndOverdraw() {
+    if (pPacket) {
+      pPacket->EndOverdraw();
+
+    } else {
+      pTarget->EndOverdraw();
+    }
+  }
+
+  void FrameQueue::Create(uint32_t depth) {
+    const uint32_t count = std::max(depth, 1u) + 1;
+
+    pPackets = std::make_unique<FramePacket[]>(count);
+    pFree.clear();
+    pFilled.clear();
+    pClosed = false;
+
+    for (uint32_t i = 0; i < count; i++) pFree.push_back(&pPackets[i]);
+  }
+
+  void FrameQueue::Release() {
+    pFree.clear();
+    pFilled.clear();
+    pPackets.reset();
+  }
+
+  FramePacket* FrameQueue::AcquireFree() {
+    std::unique_lock<std::mutex> lock(pMutex);
+    pChanged.wait(lock, [&] { return pClosed || !pFree.empty(); });
+
+    if (pClosed) return nullptr;
+
+    FramePacket* packet = pFree.front();
+    pFree.pop_front();
+
+    return packet;
+  }
+
+  void FrameQueue::Submit(FramePacket* packet) {
+    {
+      std::lock_guard<std::mutex> lock(pMutex);
+      pFilled.push_back(packet);
+    }
+
+    pChanged.notify_all();
+  }
+
+  FramePacket* FrameQueue::AcquireFilled() {
+    std::unique_lock<std::mutex> lock(pMutex);
+    pChanged.wait(lock, [&] { return pClosed || !pFilled.empty(); });
+
+    if (pFilled.empty()) return nullptr;
+
+    FramePacket* packet = pFilled.front();
+    pFilled.pop_front();
+
+    return packet;
+  }
+
+  void FrameQueue::Recycle(FramePacket* packet) {
+    {
+      std::lock_guard<std::mutex> lock(pMutex);
+      pFree.push_back(packet);
+    }
+
+    pChanged.notify_all();
+  }
+
+  void FrameQueue::Close() {
+    {
+      std::lock_guard<std::mutex> lock(pMutex);
+      pClosed = true;
+    }
+
+    pChanged.notify_all();
+  }
+
+  void FrameQueue::Reopen() {
+    std::lock_guard<std::mutex> lock(pMutex);
+    pClosed = false;
+  }
+}
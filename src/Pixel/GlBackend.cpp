@@ -0,0 +1,185 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/GlBackend.hpp"
+
+namespace Pixel {
+  void GlBackend::Init() {
+    pShader.LoadFromInlineCode(simple_vertex_shader_code, simple_fragment_shader_code);
+    pShader.Use();
+
+    int samplers[Renderer::pMaxTextures];
+    for (uint32_t i = 0; i < Renderer::pMaxTextures; i++) {
+      samplers[i] = i;
+    }
+
+    glUniform1iv(glGetUniformLocation(pShader.getProgram(), "u_textures"), Renderer::pMaxTextures, samplers);
+
+    pViewProjectionLocation = glGetUniformLocation(pShader.getProgram(), "u_view_projection");
+    pTransformLocation      = glGetUniformLocation(pShader.getProgram(), "u_transform");
+    pDebugViewLocation      = glGetUniformLocation(pShader.getProgram(), "u_debug_view");
+    pDebugColorLocation     = glGetUniformLocation(pShader.getProgram(), "u_debug_color");
+
+    pCreateBatch(pTris);
+    pCreateBatch(pLines);
+
+    Renderer::white_texture.Load(glm::vec4 {1.f, 1.f, 1.f, 1.f});
+  }
+
+  void GlBackend::Delete() {
+    pDeleteBatch(pTris);
+    pDeleteBatch(pLines);
+
+    Renderer::white_texture.Release();
+
+    pOverdrawTarget.Release();
+    pOverdrawPass.Release();
+    pShader.Release();
+  }
+
+  void GlBackend::pCreateBatch(Batch& batch) {
+    glCreateVertexArrays(1, &batch.vertex_array);
+    glBindVertexArray(batch.vertex_array);
+
+    glCreateBuffers(1, &batch.vertex_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, batch.vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, Renderer::pMaxVertexCount * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+
+    glCreateBuffers(1, &batch.index_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.index_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, Renderer::pMaxIndexCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+    glEnableVertexArrayAttrib(batch.vertex_array, 0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, position));
+
+    glEnableVertexArrayAttrib(batch.vertex_array, 1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, color));
+
+    glEnableVertexArrayAttrib(batch.vertex_array, 2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, tex_coord));
+
+    glEnableVertexArrayAttrib(batch.vertex_array, 3);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, tex_id));
+  }
+
+  void GlBackend::pDeleteBatch(Batch& batch) {
+    glDeleteVertexArrays(1, &batch.vertex_array);
+    glDeleteBuffers(1, &batch.vertex_buffer);
+    glDeleteBuffers(1, &batch.index_buffer);
+
+    batch = {};
+  }
+
+  void GlBackend::Upload(const BatchUpload& upload) {
+    const Batch& batch = upload.lines ? pLines : pTris;
+
+    pShader.Use();
+    glUniformMatrix4fv(pViewProjectionLocation, 1, GL_FALSE, &(*upload.view_projection)[0][0]);
+    glUniformMatrix4fv(pTransformLocation, 1, GL_FALSE, &(*upload.transform)[0][0]);
+
+    glBindVertexArray(batch.vertex_array);
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch.vertex_buffer);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, upload.vertex_count * sizeof(Vertex), upload.vertices);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.index_buffer);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, upload.index_count * sizeof(uint32_t), upload.indices);
+  }
+
+  void GlBackend::Draw(const BatchDraw& draw) {
+    const Batch& batch = draw.lines ? pLines : pTris;
+
+    // Timed here rather than in Renderer so the queries are issued on whichever thread replays the draws
+    Renderer::gpu_timer.Begin(draw.lines ? GpuPhase::line_flush : GpuPhase::tri_flush);
+
+    for (uint32_t i = 0; i < draw.texture_count; i++) {
+      glBindTextureUnit(i, draw.textures[i]);
+    }
+
+    glBindVertexArray(batch.vertex_array);
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch.vertex_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.index_buffer);
+
+    pShader.Use();
+    glUniform1i(pDebugViewLocation, (GLint)draw.debug_view);
+    glUniform3f(pDebugColorLocation, draw.debug_color.x, draw.debug_color.y, draw.debug_color.z);
+
+    const bool wireframe = draw.debug_view == DebugView::wireframe && !draw.lines;
+    if (wireframe) glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+
+    glDrawElements(draw.lines ? GL_LINES : GL_TRIANGLES, draw.index_count, GL_UNSIGNED_INT, nullptr);
+
+    if (wireframe) glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    Renderer::gpu_timer.End(draw.lines ? GpuPhase::line_flush : GpuPhase::tri_flush);
+  }
+
+  void GlBackend::BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) {
+    SavedTarget& saved = pTargets[pTargetDepth++];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &saved.framebuffer);
+    glGetIntegerv(GL_VIEWPORT, saved.viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target.getFramebuffer());
+    glViewport(0, 0, target.Size().x, target.Size().y);
+
+    if (clear) {
+      glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+      glClear(GL_COLOR_BUFFER_BIT);
+    }
+  }
+
+  void GlBackend::EndTarget(RenderTarget& target) {
+    target.Resolve();
+
+    const SavedTarget& saved = pTargets[--pTargetDepth];
+    glBindFramebuffer(GL_FRAMEBUFFER, saved.framebuffer);
+    glViewport(saved.viewport[0], saved.viewport[1], saved.viewport[2], saved.viewport[3]);
+  }
+
+  void GlBackend::BeginOverdraw(const glm::uvec2& size) {
+    // Only ever grows, a smaller frame uses the bottom-left corner so dynamic resolution does not reallocate it
+    if (pOverdrawTarget.getFramebuffer() == 0) {
+      pOverdrawTarget.Create(size, GL_R16F);
+      pOverdrawPass.Create(overdraw_fragment_shader_code);
+
+    } else if (size.x > pOverdrawTarget.Size().x || size.y > pOverdrawTarget.Size().y) {
+      pOverdrawTarget.Resize(glm::max(size, pOverdrawTarget.Size()));
+    }
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &pOverdrawSaved.framebuffer);
+    glGetIntegerv(GL_VIEWPORT, pOverdrawSaved.viewport);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &pOverdrawBlend[0]);
+    glGetIntegerv(GL_BLEND_DST_RGB, &pOverdrawBlend[1]);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, pOverdrawTarget.getFramebuffer());
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Every fragment writes 1, so the additive sum is the number of layers shaded at that pixel
+    glBlendFunc(GL_ONE, GL_ONE);
+  }
+
+  void GlBackend::EndOverdraw() {
+    glBindFramebuffer(GL_FRAMEBUFFER, pOverdrawSaved.framebuffer);
+    glBlendFunc(pOverdrawBlend[0], pOverdrawBlend[1]);
+
+    const glm::vec2 viewport = {pOverdrawSaved.viewport[2], pOverdrawSaved.viewport[3]};
+    pOverdrawPass.Draw(pOverdrawTarget, pOverdrawTarget.Size(), viewport / glm::vec2(pOverdrawTarget.Size()));
+  }
+}
@@ -0,0 +1,136 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/GpuTimer.hpp"
+
+namespace Pixel {
+  void GpuTimer::Create() {
+    pFrames = std::make_unique<Frame[]>(pLatency);
+    for (uint32_t i = 0; i < pLatency; i++) glCreateQueries(GL_TIMESTAMP, pMaxQueries, pFrames[i].queries);
+
+    std::fill_n(pOpen, (size_t)GpuPhase::count, -1);
+  }
+
+  void GpuTimer::Release() {
+    if (!pFrames) return;
+
+    for (uint32_t i = 0; i < pLatency; i++) glDeleteQueries(pMaxQueries, pFrames[i].queries);
+
+    pFrames.reset();
+    pRecording = false;
+  }
+
+  void GpuTimer::BeginFrame() {
+    if (!pFrames) return;
+
+    const uint32_t next = (pIndex + 1) % pLatency;
+    if (pFrames[next].pending) pCollect(next);
+
+    // The GPU is still behind on that frame's queries, reusing them would lose its results, so this frame goes untimed
+    if (pFrames[next].pending) return;
+
+    pIndex                = next;
+    pFrames[pIndex].count = 0;
+    std::fill_n(pOpen, (size_t)GpuPhase::count, -1);
+
+    pRecording = true;
+    Begin(GpuPhase::frame);
+  }
+
+  void GpuTimer::EndFrame() {
+    if (!pRecording) return;
+
+    End(GpuPhase::frame);
+
+    // Phases left open would have a missing end timestamp, so close them at the end of the frame
+    for (uint32_t phase = 0; phase < (uint32_t)GpuPhase::count; phase++) End((GpuPhase)phase);
+
+    pFrames[pIndex].pending = pFrames[pIndex].count > 0;
+    pRecording              = false;
+  }
+
+  void GpuTimer::Begin(GpuPhase phase) {
+    if (!pRecording || pOpen[(size_t)phase] >= 0) return;
+
+    Frame& frame = pFrames[pIndex];
+
+    if (frame.count + 2 > pMaxQueries) {
+      pDropped++;
+      return;
+    }
+
+    glQueryCounter(frame.queries[frame.count], GL_TIMESTAMP);
+    frame.last = frame.count;
+
+    frame.phases[frame.count / 2] = phase;
+    pOpen[(size_t)phase]          = frame.count;
+    frame.count += 2;
+  }
+
+  void GpuTimer::End(GpuPhase phase) {
+    if (!pRecording || pOpen[(size_t)phase] < 0) return;
+
+    Frame& frame = pFrames[pIndex];
+
+    glQueryCounter(frame.queries[pOpen[(size_t)phase] + 1], GL_TIMESTAMP);
+    frame.last           = pOpen[(size_t)phase] + 1;
+    pOpen[(size_t)phase] = -1;
+  }
+
+  void GpuTimer::pCollect(uint32_t index) {
+    Frame& frame = pFrames[index];
+
+    // Timestamps complete in submission order, so the last one issued being ready means the whole frame is. Until
+    // then the frame stays pending, reading the results now would block on the GPU.
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.queries[frame.last], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    frame.pending = false;
+
+    GpuTimings timings;
+
+    for (uint32_t i = 0; i < frame.count; i += 2) {
+      GLuint64 begin = 0, end = 0;
+      glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &begin);
+      glGetQueryObjectui64v(frame.queries[i + 1], GL_QUERY_RESULT, &end);
+
+      if (end > begin) timings.phases[(size_t)frame.phases[i / 2]] += (float)((end - begin) * 1e-9);
+    }
+
+    pLast                  = timings;
+    pHistory[pHistoryHead] = timings;
+    pHistoryHead           = (pHistoryHead + 1) % pWindow;
+    pHistoryCount          = std::min(pHistoryCount + 1, pWindow);
+
+    GpuTimingWindow window;
+    std::fill_n(window.min.phases, (size_t)GpuPhase::count, std::numeric_limits<float>::max());
+
+    for (uint32_t i = 0; i < pHistoryCount; i++) {
+      for (uint32_t phase = 0; phase < (uint32_t)GpuPhase::count; phase++) {
+        const float time = pHistory[i].phases[phase];
+
+        window.min.phases[phase] = std::min(window.min.phases[phase], time);
+        window.max.phases[phase] = std::max(window.max.phases[phase], time);
+        window.avg.phases[phase] += time / pHistoryCount;
+      }
+    }
+
+    pWindowStats = window;
+  }
+}
@@ -0,0 +1,207 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.hpp"
+#include "Pixel/JobSystem.hpp"
+#include "Util/Profiler.hpp"
+
+namespace Pixel {
+  // The job system a thread works for and its queue there, threads that are not workers use the shared queue
+  static thread_local const JobSystem* current_system = nullptr;
+  static thread_local uint32_t         current_queue  = 0;
+
+  JobSystem::~JobSystem() { Release(); }
+
+  void JobSystem::Create(uint32_t workers) {
+    Release();
+
+    pWorkerCount = workers != 0 ? workers : std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    pQueues      = std::make_unique<Queue[]>(pWorkerCount + 1);
+    pStopping    = false;
+
+    pWorkers.reserve(pWorkerCount);
+    for (uint32_t i = 0; i < pWorkerCount; i++) pWorkers.emplace_back(&JobSystem::pWorker, this, i);
+  }
+
+  // Jobs still queued are run here, so nothing waiting on a counter is left hanging
+  void JobSystem::Release() {
+    if (!pQueues) return;
+
+    {
+      std::lock_guard<std::mutex> lock(pSleepMutex);
+      pStopping = true;
+    }
+
+    pWake.notify_all();
+
+    for (auto& worker : pWorkers) worker.join();
+    pWorkers.clear();
+
+    for (Task task; pFind(task);) pExecute(task);
+
+    pQueues.reset();
+    pWorkerCount = 0;
+  }
+
+  JobSystem& JobSystem::Default() {
+    static JobSystem      system;
+    static std::once_flag created;
+
+    std::call_once(created, [] { system.Create(); });
+    return system;
+  }
+
+  void JobSystem::Run(Job job, JobCounter* signal) {
+    if (signal) signal->pPending.fetch_add(1, std::memory_order_relaxed);
+    pPush({std::move(job), signal});
+  }
+
+  void JobSystem::Run(Job job, JobCounter* signal, JobCounter& after) {
+    if (signal) signal->pPending.fetch_add(1, std::memory_order_relaxed);
+
+    {
+      // Checked under the lock the draining job takes before handing out continuations, so none is ever missed
+      std::lock_guard<std::mutex> lock(after.pMutex);
+
+      if (!after.Done()) {
+        after.pContinuations.push_back({std::move(job), signal});
+        return;
+      }
+    }
+
+    pPush({std::move(job), signal});
+  }
+
+  void JobSystem::Wait(const JobCounter& counter) {
+    while (!counter.Done()) {
+      Task task;
+
+      if (pFind(task)) {
+        pExecute(task);
+
+      } else {
+        std::this_thread::yield();
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(counter.pMutex);
+  }
+
+  void JobSystem::ParallelFor(uint32_t                                                 count,
+                              uint32_t                                                 grain,
+                              const std::function<void(uint32_t begin, uint32_t end)>& body) {
+    grain = std::max(grain, 1u);
+
+    if (count <= grain || pWorkerCount == 0) {
+      if (count > 0) body(0, count);
+      return;
+    }
+
+    JobCounter counter;
+
+    // The first range is kept for the calling thread, which would otherwise start its wait by stealing one back
+    for (uint32_t begin = grain; begin < count; begin += grain) {
+      const uint32_t end = std::min(begin + grain, count);
+      Run([&body, begin, end] { body(begin, end); }, &counter);
+    }
+
+    body(0, grain);
+    Wait(counter);
+  }
+
+  void JobSystem::pPush(Task task) {
+    const uint32_t queue = current_system == this ? current_queue : pWorkerCount;
+
+    {
+      std::lock_guard<std::mutex> lock(pQueues[queue].mutex);
+      pQueues[queue].tasks.push_back(std::move(task));
+      pQueued.fetch_add(1, std::memory_order_release);
+    }
+
+    // Taking the lock orders this against a worker between checking pQueued and going to sleep
+    { std::lock_guard<std::mutex> lock(pSleepMutex); }
+    pWake.notify_one();
+  }
+
+  // Newest first from the own queue, which is likely still in cache, then oldest first from the others
+  bool JobSystem::pFind(Task& task) {
+    if (pQueued.load(std::memory_order_acquire) == 0) return false;
+
+    const uint32_t queues = pWorkerCount + 1;
+    const uint32_t own    = current_system == this ? current_queue : pWorkerCount;
+
+    for (uint32_t i = 0; i < queues; i++) {
+      Queue&                      queue = pQueues[(own + i) % queues];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+
+      if (queue.tasks.empty()) continue;
+
+      if (i == 0) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+
+      } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+
+      pQueued.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    return false;
+  }
+
+  void JobSystem::pExecute(Task& task) {
+    task.job();
+
+    JobCounter* signal = task.signal;
+    if (!signal) return;
+
+    std::vector<JobCounter::Continuation> continuations;
+
+    {
+      // The counter may belong to a waiter that returns as soon as it drains, Wait takes this lock before returning
+      std::lock_guard<std::mutex> lock(signal->pMutex);
+      if (signal->pPending.fetch_sub(1, std::memory_order_acq_rel) == 1) continuations.swap(signal->pContinuations);
+    }
+
+    for (auto& continuation : continuations) pPush({std::move(continuation.job), continuation.signal});
+  }
+
+  void JobSystem::pWorker(uint32_t worker) {
+    PIXEL_PROFILE_THREAD("Job worker");
+
+    current_system = this;
+    current_queue  = worker;
+
+    while (true) {
+      Task task;
+
+      if (pFind(task)) {
+        pExecute(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(pSleepMutex);
+      pWake.wait(lock, [&] { return pStopping || pQueued.load(std::memory_order_acquire) > 0; });
+
+      if (pStopping) return;
+    }
+  }
+}
@@ -0,0 +1,70 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/NullBackend.hpp"
+
+namespace Pixel {
+  void NullBackend::Init() { Reset(); }
+  void NullBackend::Delete() {}
+
+  // FNV-1a over 32-bit words, every field submitted is a float or a 32-bit integer so nothing is left over
+  void NullBackend::pHash(const void* bytes, size_t size) {
+    const uint32_t* words = (const uint32_t*)bytes;
+
+    for (size_t i = 0; i < size / sizeof(uint32_t); i++) {
+      pCounters.checksum = (pCounters.checksum ^ words[i]) * 0x100000001b3ull;
+    }
+  }
+
+  void NullBackend::Upload(const BatchUpload& batch) {
+    pCounters.uploads++;
+    pCounters.vertices += batch.vertex_count;
+    pCounters.bytes += batch.vertex_count * sizeof(Vertex) + batch.index_count * sizeof(uint32_t);
+
+    pHash(batch.vertices, batch.vertex_count * sizeof(Vertex));
+    pHash(batch.indices, batch.index_count * sizeof(uint32_t));
+    pHash(batch.view_projection, sizeof(glm::mat4));
+    pHash(batch.transform, sizeof(glm::mat4));
+  }
+
+  void NullBackend::Draw(const BatchDraw& draw) {
+    pCounters.draws++;
+    pCounters.indices += draw.index_count;
+    pCounters.texture_binds += draw.texture_count;
+
+    const uint32_t header[3] = {draw.lines, draw.index_count, (uint32_t)draw.debug_view};
+    pHash(header, sizeof(header));
+    pHash(draw.textures, draw.texture_count * sizeof(uint32_t));
+  }
+
+  void NullBackend::BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) {
+    pCounters.targets++;
+  }
+
+  void NullBackend::EndTarget(RenderTarget& target) {}
+
+  void NullBackend::BeginOverdraw(const glm::uvec2& size) { pCounters.overdraw_passes++; }
+  void NullBackend::EndOverdraw() {}
+
+  const NullBackendCounters& NullBackend::Counters() const { return pCounters; }
+
+  void NullBackend::Reset() {
+    pCounters          = {};
+    pCounters.checksum = 0xcbf29ce484222325ull;
+  }
+}
@@ -0,0 +1,206 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/PerfHud.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Pixel/Texture.hpp"
+
+namespace Pixel {
+  static constexpr const char* gpu_phase_names[(size_t)GpuPhase::count] = {
+      "Frame", "World", "Triangle flushes", "Line flushes", "Post process", "ImGui"};
+
+  static constexpr float frame_budgets[] = {1.f / 60.f, 1.f / 30.f};
+
+  static constexpr std::pair<const char*, DebugView> debug_views[] = {
+      {"None", DebugView::none},
+      {"Overdraw", DebugView::overdraw},
+      {"Batches", DebugView::batches},
+      {"Wireframe", DebugView::wireframe},
+  };
+
+  void PerfHud::pRefresh(const MetricsRegistry& metrics) {
+    pSummaryCount = std::min(metrics.Size(), pMaxMetrics);
+    for (uint32_t i = 0; i < pSummaryCount; i++) pSummaries[i] = metrics.Get(i).Summary();
+
+    pZoneCount = Profiler::LastFrameZones(pZones, pMaxZones);
+
+    pFlushLog       = Renderer::LastFrameFlushes();
+    pFlushSiteCount = Renderer::LastFrameFlushSites(pFlushSites, pMaxFlushSites);
+  }
+
+  void PerfHud::Draw(const MetricsRegistry& metrics, uint32_t frame_time_metric) {
+    PIXEL_PROFILE_SCOPE("PerfHud::Draw");
+
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now - pLastRefresh >= std::chrono::duration<float>(pRefreshInterval)) {
+      pRefresh(metrics);
+      pLastRefresh = now;
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(10.f, 10.f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowBgAlpha(.85f);
+
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing;
+
+    if (!ImGui::Begin("Performance", nullptr, flags)) {
+      ImGui::End();
+      return;
+    }
+
+    const Metric&        frame   = metrics.Get(frame_time_metric);
+    const MetricSummary& summary = pSummaries[frame_time_metric];
+
+    ImGui::Text("%.2f ms (%.0f fps)", frame.Last() * 1000.f, frame.Last() > 0.f ? 1.f / frame.Last() : 0.f);
+    ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms",
+                summary.p50 * 1000.f,
+                summary.p95 * 1000.f,
+                summary.p99 * 1000.f,
+                summary.max * 1000.f);
+
+    // Oldest sample on the left, the scale always leaves room for the 30 fps budget line
+    const float scale = std::max(summary.max, frame_budgets[1]) * 1100.f;
+
+    ImGui::PlotLines(
+        "##frame_time",
+        [](void* data, int index) {
+          const Metric& metric = *(const Metric*)data;
+          return metric.Sample(metric.Count() - 1 - index) * 1000.f;
+        },
+        (void*)&frame,
+        (int)frame.Count(),
+        0,
+        nullptr,
+        0.f,
+        scale,
+        ImVec2(360.f, 90.f));
+
+    const ImVec2 graph_min = ImGui::GetItemRectMin();
+    const ImVec2 graph_max = ImGui::GetItemRectMax();
+    ImDrawList*  draw_list = ImGui::GetWindowDrawList();
+
+    for (float budget : frame_budgets) {
+      const float y = graph_max.y - (budget * 1000.f / scale) * (graph_max.y - graph_min.y);
+      draw_list->AddLine(ImVec2(graph_min.x, y), ImVec2(graph_max.x, y), IM_COL32(255, 80, 80, 160));
+    }
+
+    if (ImGui::CollapsingHeader("Metrics", ImGuiTreeNodeFlags_DefaultOpen) &&
+        ImGui::BeginTable("##metrics", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+      ImGui::TableSetupColumn("Metric");
+      ImGui::TableSetupColumn("Last");
+      ImGui::TableSetupColumn("p50");
+      ImGui::TableSetupColumn("p99");
+      ImGui::TableSetupColumn("Max");
+      ImGui::TableHeadersRow();
+
+      for (uint32_t i = 0; i < pSummaryCount; i++) {
+        const Metric&        metric = metrics.Get(i);
+        const MetricSummary& values = pSummaries[i];
+
+        // Times read best in milliseconds, counters as whole numbers
+        const bool  time = metric.Unit() == MetricUnit::seconds;
+        const float unit = time ? 1000.f : 1.f;
+        const char* fmt  = time ? "%.2f" : "%.0f";
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(metric.Name().c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text(fmt, metric.Last() * unit);
+        ImGui::TableNextColumn();
+        ImGui::Text(fmt, values.p50 * unit);
+        ImGui::TableNextColumn();
+        ImGui::Text(fmt, values.p99 * unit);
+        ImGui::TableNextColumn();
+        ImGui::Text(fmt, values.max * unit);
+      }
+
+      ImGui::EndTable();
+    }
+
+    if (ImGui::CollapsingHeader("GPU", ImGuiTreeNodeFlags_DefaultOpen) &&
+        ImGui::BeginTable("##gpu", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+      const Renderer::Stats& stats = Renderer::GetStats();
+
+      ImGui::TableSetupColumn("Phase (ms)");
+      ImGui::TableSetupColumn("Last");
+      ImGui::TableSetupColumn("Avg");
+      ImGui::TableSetupColumn("Max");
+      ImGui::TableHeadersRow();
+
+      for (uint32_t phase = 0; phase < (uint32_t)GpuPhase::count; phase++) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(gpu_phase_names[phase]);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", stats.gpu.phases[phase] * 1000.f);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", stats.gpu_window.avg.phases[phase] * 1000.f);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", stats.gpu_window.max.phases[phase] * 1000.f);
+      }
+
+      ImGui::EndTable();
+    }
+
+    ImGui::Text("Texture memory: %.1f MB", Texture::AllocatedBytes() / (1024.f * 1024.f));
+
+    ImGui::TextUnformatted("Debug view:");
+
+    for (const auto& [name, view] : debug_views) {
+      ImGui::SameLine();
+      if (ImGui::RadioButton(name, Renderer::GetDebugView() == view)) Renderer::SetDebugView(view);
+    }
+
+    if (ImGui::CollapsingHeader("Batch flushes", ImGuiTreeNodeFlags_DefaultOpen)) {
+      ImGui::Text("%u last frame", pFlushLog.total);
+
+      for (uint32_t reason = 0; reason < (uint32_t)FlushReason::count; reason++) {
+        if (pFlushLog.counts[reason] > 0) {
+          ImGui::Text("  %-16s %u", FlushReasonName((FlushReason)reason), pFlushLog.counts[reason]);
+        }
+      }
+
+      for (uint32_t i = 0; i < pFlushSiteCount; i++) {
+        const FlushSite& site = pFlushSites[i];
+        const char*      file = std::strrchr(site.location.file_name(), '/');
+
+        ImGui::Text("%4u  %-5s %-16s %s:%u",
+                    site.count,
+                    site.lines ? "lines" : "tris",
+                    FlushReasonName(site.reason),
+                    file ? file + 1 : site.location.file_name(),
+                    (uint32_t)site.location.line());
+      }
+    }
+
+    if (ImGui::CollapsingHeader("Profiler zones", ImGuiTreeNodeFlags_DefaultOpen)) {
+#ifdef PIXEL_PROFILING
+      if (pZoneCount == 0) ImGui::TextUnformatted("No zones recorded in the last frame");
+
+      for (uint32_t i = 0; i < pZoneCount; i++) {
+        ImGui::Text("%7.3f ms  %4u  %s", pZones[i].time * 1e-6f, pZones[i].calls, pZones[i].name);
+      }
+#else
+      ImGui::TextUnformatted("Profiler compiled out, configure with PIXEL_PROFILING=ON");
+#endif
+    }
+
+    ImGui::End();
+  }
+}
@@ -0,0 +1,54 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/PostProcess.hpp"
+
+namespace Pixel {
+  void FullscreenPass::Create(std::string_view fragment_code) {
+    pShader.LoadFromInlineCode(fullscreen_vertex_shader_code, fragment_code);
+    glCreateVertexArrays(1, &pVertexArray);
+
+    pSourceLocation  = glGetUniformLocation(pShader.getProgram(), "u_source");
+    pTexelLocation   = glGetUniformLocation(pShader.getProgram(), "u_texel");
+    pUvScaleLocation = glGetUniformLocation(pShader.getProgram(), "u_uv_scale");
+  }
+
+  void FullscreenPass::Release() {
+    if (pVertexArray != 0) glDeleteVertexArrays(1, &pVertexArray);
+    pShader.Release();
+
+    pVertexArray = 0;
+  }
+
+  void FullscreenPass::Draw(const Texture& source, const glm::uvec2& source_size, const glm::vec2& uv_scale) {
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+
+    pShader.Use();
+    glBindTextureUnit(0, source.getId());
+
+    glUniform1i(pSourceLocation, 0);
+    glUniform2f(pTexelLocation, 1.f / source_size.x, 1.f / source_size.y);
+    glUniform2f(pUvScaleLocation, uv_scale.x, uv_scale.y);
+
+    glBindVertexArray(pVertexArray);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    if (blend) glEnable(GL_BLEND);
+  }
+}
@@ -0,0 +1,119 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/RenderTarget.hpp"
+#include "Util/Logger.hpp"
+
+namespace Pixel {
+  static uint32_t BytesPerPixel(GLenum internal_format) {
+    switch (internal_format) {
+      case GL_R8:
+        return 1;
+
+      case GL_R16F:
+      case GL_RG8:
+        return 2;
+
+      case GL_RGBA16F:
+      case GL_RG32F:
+        return 8;
+
+      case GL_RGBA32F:
+        return 16;
+
+      default:
+        return 4;
+    }
+  }
+
+  void RenderTarget::Create(const glm::uvec2& size, GLenum internal_format, uint32_t samples) {
+    pSize           = glm::max(size, glm::uvec2 {1, 1});
+    pInternalFormat = internal_format;
+    pSamples        = samples > 1 ? samples : 0;
+    pValid          = false;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &pId);
+    glTextureParameteri(pId, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(pId, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(pId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(pId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureStorage2D(pId, 1, internal_format, pSize.x, pSize.y);
+
+    const uint64_t pixel_bytes = (uint64_t)pSize.x * pSize.y * BytesPerPixel(internal_format);
+    pTrackMemory(pixel_bytes * (pSamples + 1));  // The multisampled renderbuffer, when present, is counted here too
+
+    glCreateFramebuffers(1, &pFramebuffer);
+    glNamedFramebufferTexture(pFramebuffer, GL_COLOR_ATTACHMENT0, pId, 0);
+
+    if (glCheckNamedFramebufferStatus(pFramebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+      Logger::Die("Render target framebuffer is incomplete");
+    }
+
+    if (pSamples == 0) return;
+
+    glCreateRenderbuffers(1, &pMultisampleRenderbuffer);
+    glNamedRenderbufferStorageMultisample(pMultisampleRenderbuffer, pSamples, internal_format, pSize.x, pSize.y);
+
+    glCreateFramebuffers(1, &pMultisampleFramebuffer);
+    glNamedFramebufferRenderbuffer(
+        pMultisampleFramebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, pMultisampleRenderbuffer);
+
+    if (glCheckNamedFramebufferStatus(pMultisampleFramebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+      Logger::Die("Multisampled render target framebuffer is incomplete");
+    }
+  }
+
+  void RenderTarget::Resize(const glm::uvec2& size) {
+    if (glm::max(size, glm::uvec2 {1, 1}) == pSize && pFramebuffer != 0) return;
+
+    Release();
+    Create(size, pInternalFormat, pSamples);
+  }
+
+  void RenderTarget::Release() {
+    if (pMultisampleFramebuffer != 0) glDeleteFramebuffers(1, &pMultisampleFramebuffer);
+    if (pMultisampleRenderbuffer != 0) glDeleteRenderbuffers(1, &pMultisampleRenderbuffer);
+    if (pFramebuffer != 0) glDeleteFramebuffers(1, &pFramebuffer);
+    Texture::Release();
+
+    pMultisampleFramebuffer  = 0;
+    pMultisampleRenderbuffer = 0;
+    pFramebuffer             = 0;
+    pId                      = 0;
+    pValid                   = false;
+  }
+
+  void RenderTarget::Resolve() { Resolve(pSize); }
+
+  void RenderTarget::Resolve(const glm::uvec2& region) {
+    if (pSamples == 0) return;
+
+    glBlitNamedFramebuffer(pMultisampleFramebuffer,
+                           pFramebuffer,
+                           0,
+                           0,
+                           region.x,
+                           region.y,
+                           0,
+                           0,
+                           region.x,
+                           region.y,
+                           GL_COLOR_BUFFER_BIT,
+                           GL_NEAREST);
+  }
+}
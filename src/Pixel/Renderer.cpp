@@ -17,20 +17,19 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include "Pixel/Renderer.hpp"
-#include "Pixel/Shader.hpp"
+#include "Pixel/GlBackend.hpp"
 #include "Pixel/Texture.hpp"
+#include "Util/Logger.hpp"
+#include "Util/Profiler.hpp"
 #include "pch.hpp"
 
 namespace Pixel {
-  static struct {
-    GLuint gl_tri_vertex_array  = 0;
-    GLuint gl_line_vertex_array = 0;
-
-    GLuint gl_tri_vertex_buffer = 0;
-    GLuint gl_tri_index_buffer  = 0;
+  static GlBackend gl_backend;
 
-    GLuint gl_line_vertex_buffer = 0;
-    GLuint gl_line_index_buffer  = 0;
+  static struct {
+    RenderBackend   *backend        = &gl_backend;
+    RenderBackend   *custom_backend = nullptr;
+    CommandRecorder *recorder       = nullptr;
 
     Vertex   *tri_vertex_buffer         = nullptr;
     Vertex   *tri_vertex_buffer_current = nullptr;
@@ -47,99 +46,74 @@ namespace Pixel {
     uint32_t texture_slots[Renderer::pMaxTextures] = {};
     uint32_t texture_slot_index                    = 0;
 
-    Renderer::Stats stats = {};
-
-    std::unique_ptr<ShaderProgram> shader_program;
+    Renderer::Stats stats         = {};
+    bool            gpu_published = false;  // Whether stats.gpu comes from PublishGpuTimings instead of gpu_timer
 
     glm::mat4 view_projection = glm::mat4(1.f);
     glm::mat4 transform       = glm::mat4(1.f);
-  } data;
 
-  Texture Renderer::white_texture = Texture();
+    glm::mat4 view_projection_override     = glm::mat4(1.f);
+    bool      has_view_projection_override = false;
 
-  void Renderer::Init() {
-    // Shaders
-    data.shader_program = std::make_unique<ShaderProgram>();
-    data.shader_program->LoadFromInlineCode(simple_vertex_shader_code, simple_fragment_shader_code);
-    data.shader_program->Use();
-
-    int samplers[pMaxTextures];
-    for (uint32_t i = 0; i < pMaxTextures; i++) {
-      samplers[i] = i;
-    }
+    struct TargetState {
+      RenderTarget *target          = nullptr;
+      glm::mat4     view_projection = glm::mat4(1.f);
+      glm::mat4     transform       = glm::mat4(1.f);
+    } target_stack[Renderer::pMaxTargetDepth];
 
-    glUniform1iv(glGetUniformLocation(data.shader_program->getProgram(), "u_textures"), pMaxTextures, samplers);
+    uint32_t target_depth = 0;
 
-    // Dynamic arrays
-    data.tri_vertex_buffer = new Vertex[pMaxVertexCount];
-    data.tri_index_buffer  = new uint32_t[pMaxIndexCount];
+    FlushLog flush_logs[2]     = {};
+    uint32_t flush_log_current = 0;
 
-    data.line_vertex_buffer = new Vertex[pMaxVertexCount];
-    data.line_index_buffer  = new uint32_t[pMaxIndexCount];
-
-    // Tris
-    glCreateVertexArrays(1, &data.gl_tri_vertex_array);
-    glBindVertexArray(data.gl_tri_vertex_array);
-
-    glCreateBuffers(1, &data.gl_tri_vertex_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, data.gl_tri_vertex_buffer);
-    glBufferData(GL_ARRAY_BUFFER, pMaxVertexCount * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
-
-    glCreateBuffers(1, &data.gl_tri_index_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.gl_tri_index_buffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, pMaxIndexCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+    DebugView debug_view      = DebugView::none;
+    uint32_t  debug_batch     = 0;
+    bool      overdraw_active = false;
+  } data;
 
-    glEnableVertexArrayAttrib(data.gl_tri_vertex_array, 0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)offsetof(Vertex, position));
+  Texture  Renderer::white_texture = Texture();
+  GpuTimer Renderer::gpu_timer     = GpuTimer();
 
-    glEnableVertexArrayAttrib(data.gl_tri_vertex_array, 1);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)offsetof(Vertex, color));
+  const char *FlushReasonName(FlushReason reason) {
+    switch (reason) {
+      case FlushReason::index_capacity:
+        return "index_capacity";
 
-    glEnableVertexArrayAttrib(data.gl_tri_vertex_array, 2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)offsetof(Vertex, tex_coord));
+      case FlushReason::vertex_capacity:
+        return "vertex_capacity";
 
-    glEnableVertexArrayAttrib(data.gl_tri_vertex_array, 3);
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)offsetof(Vertex, tex_id));
+      case FlushReason::texture_slots:
+        return "texture_slots";
 
-    // Lines
-    glCreateVertexArrays(1, &data.gl_line_vertex_array);
-    glBindVertexArray(data.gl_line_vertex_array);
+      case FlushReason::target:
+        return "target";
 
-    glCreateBuffers(1, &data.gl_line_vertex_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, data.gl_line_vertex_buffer);
-    glBufferData(GL_ARRAY_BUFFER, pMaxVertexCount * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+      default:
+        return "manual";
+    }
+  }
 
-    glCreateBuffers(1, &data.gl_line_index_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.gl_line_index_buffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, pMaxIndexCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+  void Renderer::SetBackend(RenderBackend *backend) { data.custom_backend = backend; }
+  void Renderer::SetRecorder(CommandRecorder *recorder) { data.recorder = recorder; }
 
-    glEnableVertexArrayAttrib(data.gl_line_vertex_array, 0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)offsetof(Vertex, position));
+  RenderBackend &Renderer::Backend() { return *data.backend; }
 
-    glEnableVertexArrayAttrib(data.gl_line_vertex_array, 1);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)offsetof(Vertex, color));
+  void Renderer::Init() {
+    data.backend = data.custom_backend ? data.custom_backend : &gl_backend;
+    data.backend->Init();
 
-    glEnableVertexArrayAttrib(data.gl_line_vertex_array, 2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)offsetof(Vertex, tex_coord));
+    // Dynamic arrays
+    data.tri_vertex_buffer = new Vertex[pMaxVertexCount];
+    data.tri_index_buffer  = new uint32_t[pMaxIndexCount];
 
-    glEnableVertexArrayAttrib(data.gl_line_vertex_array, 3);
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)offsetof(Vertex, tex_id));
+    data.line_vertex_buffer = new Vertex[pMaxVertexCount];
+    data.line_index_buffer  = new uint32_t[pMaxIndexCount];
 
-    white_texture.Load(glm::vec4 {1.f, 1.f, 1.f, 1.f});
     memset(data.texture_slots, 0, pMaxTextures * sizeof(data.texture_slots[0]));
   }
 
   void Renderer::Delete() {
-    glDeleteVertexArrays(1, &data.gl_tri_vertex_array);
-    glDeleteVertexArrays(1, &data.gl_line_vertex_array);
-
-    glDeleteBuffers(1, &data.gl_tri_vertex_buffer);
-    glDeleteBuffers(1, &data.gl_tri_index_buffer);
-
-    glDeleteBuffers(1, &data.gl_line_vertex_buffer);
-    glDeleteBuffers(1, &data.gl_line_index_buffer);
-
-    white_texture.Release();
+    data.backend->Delete();
 
     delete[] data.tri_vertex_buffer;
     delete[] data.tri_index_buffer;
@@ -152,77 +126,123 @@ namespace Pixel {
 
   void BeginLineBatch() { data.line_vertex_buffer_current = data.line_vertex_buffer; }
 
+  template <typename... Args>
+  static void Record(RenderCommand command, const Args &...args) {
+    if (data.recorder) data.recorder->Record(command, args...);
+  }
+
+  static const glm::mat4 &CurrentViewProjection() {
+    return data.has_view_projection_override ? data.view_projection_override : data.view_projection;
+  }
+
   void EndTriBatch() {
-    data.shader_program->Use();
+    PIXEL_PROFILE_SCOPE("Renderer::EndTriBatch");
+
+    data.backend->Upload({false,
+                          data.tri_vertex_buffer,
+                          data.tri_vertex_count,
+                          data.tri_index_buffer,
+                          data.tri_index_count,
+                          &CurrentViewProjection(),
+                          &data.transform});
+  }
 
-    glUniformMatrix4fv(glGetUniformLocation(data.shader_program->getProgram(), "u_view_projection"),
-                       1,
-                       GL_FALSE,
-                       &data.view_projection[0][0]);
+  void EndLineBatch() {
+    PIXEL_PROFILE_SCOPE("Renderer::EndLineBatch");
+
+    data.backend->Upload({true,
+                          data.line_vertex_buffer,
+                          data.line_vertex_count,
+                          data.line_index_buffer,
+                          data.line_index_count,
+                          &CurrentViewProjection(),
+                          &data.transform});
+  }
 
-    glUniformMatrix4fv(
-        glGetUniformLocation(data.shader_program->getProgram(), "u_transform"), 1, GL_FALSE, &data.transform[0][0]);
+  static void RecordFlush(FlushReason reason, bool lines, uint32_t index_count, const std::source_location &location) {
+    FlushLog &log = data.flush_logs[data.flush_log_current];
 
-    glBindVertexArray(data.gl_tri_vertex_array);
+    log.counts[(size_t)reason]++;
+    log.total++;
 
-    glBindBuffer(GL_ARRAY_BUFFER, data.gl_tri_vertex_buffer);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, data.tri_vertex_count * sizeof(Vertex), data.tri_vertex_buffer);
+    if (log.total > FlushLog::pMaxEvents) {
+      log.dropped++;
+      return;
+    }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.gl_tri_index_buffer);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, data.tri_index_count * sizeof(uint32_t), data.tri_index_buffer);
+    log.events[log.total - 1] = {reason, lines, index_count, location};
   }
 
-  void EndLineBatch() {
-    data.shader_program->Use();
+  // Spreads consecutive batches around the hue circle by the golden ratio so neighbours never get similar colors
+  static glm::vec3 BatchColor(uint32_t batch) {
+    const float hue = std::fmod(batch * 0.618034f, 1.f) * 6.f;
+    const float x   = 1.f - std::abs(std::fmod(hue, 2.f) - 1.f);
 
-    glUniformMatrix4fv(glGetUniformLocation(data.shader_program->getProgram(), "u_view_projection"),
-                       1,
-                       GL_FALSE,
-                       &data.view_projection[0][0]);
+    switch ((uint32_t)hue) {
+      case 0:
+        return {1.f, x, 0.f};
 
-    glUniformMatrix4fv(
-        glGetUniformLocation(data.shader_program->getProgram(), "u_transform"), 1, GL_FALSE, &data.transform[0][0]);
+      case 1:
+        return {x, 1.f, 0.f};
 
-    glBindVertexArray(data.gl_line_vertex_array);
+      case 2:
+        return {0.f, 1.f, x};
 
-    glBindBuffer(GL_ARRAY_BUFFER, data.gl_line_vertex_buffer);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, data.line_vertex_count * sizeof(Vertex), data.line_vertex_buffer);
+      case 3:
+        return {0.f, x, 1.f};
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.gl_line_index_buffer);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, data.line_index_count * sizeof(uint32_t), data.line_index_buffer);
+      case 4:
+        return {x, 0.f, 1.f};
+
+      default:
+        return {1.f, 0.f, x};
+    }
   }
 
-  void FlushTriBatch() {
-    for (uint32_t i = 0; i < data.texture_slot_index; i++) {
-      glBindTextureUnit(i, data.texture_slots[i]);
+  static void DrawBatch(bool lines, uint32_t index_count) {
+    BatchDraw draw     = {};
+    draw.lines         = lines;
+    draw.index_count   = index_count;
+    draw.textures      = data.texture_slots;
+    draw.texture_count = data.texture_slot_index;
+    draw.debug_view    = data.debug_view;
+
+    if (data.debug_view == DebugView::batches) draw.debug_color = BatchColor(data.debug_batch++);
+
+    data.backend->Draw(draw);
+  }
+
+  void FlushTriBatch(FlushReason reason, const std::source_location &location) {
+    PIXEL_PROFILE_SCOPE("Renderer::FlushTriBatch");
+
+    // Nothing to draw, but the texture slots still start over like they would after a draw
+    if (data.tri_index_count == 0) {
+      data.texture_slot_index = 1;
+      return;
     }
 
-    glBindVertexArray(data.gl_tri_vertex_array);
+    RecordFlush(reason, false, data.tri_index_count, location);
 
-    glBindBuffer(GL_ARRAY_BUFFER, data.gl_tri_vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.gl_tri_index_buffer);
-    glDrawElements(GL_TRIANGLES, data.tri_index_count, GL_UNSIGNED_INT, nullptr);
+    DrawBatch(false, data.tri_index_count);
 
     data.stats.tri_index_count += data.tri_index_count;
     data.stats.tri_vertex_count += data.tri_vertex_count;
 
     data.tri_index_count    = 0;
     data.tri_vertex_count   = 0;
-    data.texture_slot_index = 0;
+    data.texture_slot_index = 1;  // Slot 0 always holds the white texture untextured primitives sample
 
     data.stats.draw_calls++;
   }
 
-  void FlushLineBatch() {
-    for (uint32_t i = 0; i < data.texture_slot_index; i++) {
-      glBindTextureUnit(i, data.texture_slots[i]);
-    }
+  void FlushLineBatch(FlushReason reason, const std::source_location &location) {
+    PIXEL_PROFILE_SCOPE("Renderer::FlushLineBatch");
+
+    if (data.line_index_count == 0) return;
 
-    glBindVertexArray(data.gl_line_vertex_array);
+    RecordFlush(reason, true, data.line_index_count, location);
 
-    glBindBuffer(GL_ARRAY_BUFFER, data.gl_line_vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.gl_line_index_buffer);
-    glDrawElements(GL_LINES, data.line_index_count, GL_UNSIGNED_INT, nullptr);
+    DrawBatch(true, data.line_index_count);
 
     data.stats.line_index_count += data.line_index_count;
     data.stats.line_vertex_count += data.line_vertex_count;
@@ -234,33 +254,103 @@ namespace Pixel {
   }
 
   void Renderer::BeginBatch() {
-    data.texture_slots[0] = white_texture.getId();
-    data.texture_slot_index++;
+    Record(RenderCommand::begin_batch);
+
+    data.texture_slots[0]   = white_texture.getId();
+    data.texture_slot_index = 1;
 
     BeginTriBatch();
     BeginLineBatch();
   }
 
   void Renderer::EndBatch() {
+    Record(RenderCommand::end_batch);
+
     EndTriBatch();
     EndLineBatch();
   }
 
-  void Renderer::FlushBatch() {
-    FlushTriBatch();
-    FlushLineBatch();
+  void Renderer::FlushBatch(const Location &location) {
+    Record(RenderCommand::flush_batch);
+
+    FlushTriBatch(FlushReason::manual, location);
+    FlushLineBatch(FlushReason::manual, location);
+  }
+
+  static void FlushTris(FlushReason reason, const std::source_location &location) {
+    EndTriBatch();
+    FlushTriBatch(reason, location);
+    BeginTriBatch();
+  }
+
+  static void FlushLines(FlushReason reason, const std::source_location &location) {
+    EndLineBatch();
+    FlushLineBatch(reason, location);
+    BeginLineBatch();
+  }
+
+  static void FlushPending(const std::source_location &location) {
+    FlushTris(FlushReason::target, location);
+    FlushLines(FlushReason::target, location);
+  }
+
+  // Flushes the batch when the next primitive would not fit, index space is checked first so each flush gets one reason
+  static void ReserveTris(uint32_t index_count, uint32_t vertex_count, const std::source_location &location) {
+    if ((data.tri_index_count + index_count) >= Renderer::pMaxIndexCount) {
+      FlushTris(FlushReason::index_capacity, location);
+
+    } else if ((data.tri_vertex_count + vertex_count) >= Renderer::pMaxVertexCount) {
+      FlushTris(FlushReason::vertex_capacity, location);
+    }
+  }
+
+  static void ReserveLines(uint32_t index_count, uint32_t vertex_count, const std::source_location &location) {
+    if ((data.line_index_count + index_count) >= Renderer::pMaxIndexCount) {
+      FlushLines(FlushReason::index_capacity, location);
+
+    } else if ((data.line_vertex_count + vertex_count) >= Renderer::pMaxVertexCount) {
+      FlushLines(FlushReason::vertex_capacity, location);
+    }
+  }
+
+  void Renderer::BeginTarget(RenderTarget &target, bool clear, const glm::vec4 &clear_color, const Location &location) {
+    Record(RenderCommand::begin_target, target, clear, clear_color);
+
+    if (data.target_depth == pMaxTargetDepth) Logger::Die("Render targets nested too deeply");
+
+    FlushPending(location);
+
+    auto &state           = data.target_stack[data.target_depth++];
+    state.target          = &target;
+    state.view_projection = data.view_projection;
+    state.transform       = data.transform;
+
+    data.backend->BeginTarget(target, clear, clear_color);
+  }
+
+  void Renderer::EndTarget(const Location &location) {
+    Record(RenderCommand::end_target);
+
+    if (data.target_depth == 0) Logger::Die("Renderer::EndTarget called without a matching BeginTarget");
+
+    FlushPending(location);
+
+    auto &state = data.target_stack[--data.target_depth];
+    data.backend->EndTarget(*state.target);
+    state.target->pValid = true;
+
+    data.view_projection = state.view_projection;
+    data.transform       = state.transform;
   }
 
   void Renderer::DrawQuad(const glm::vec2 &position,
                           const glm::vec2 &size,
                           const glm::vec4 &color,
-                          const Texture   &texture) {
-    if ((data.tri_index_count + 6) >= pMaxIndexCount || (data.tri_vertex_count + 4) >= pMaxVertexCount ||
-        data.texture_slot_index > (pMaxTextures - 1)) {
-      EndTriBatch();
-      FlushTriBatch();
-      BeginTriBatch();
-    }
+                          const Texture   &texture,
+                          const Location  &location) {
+    Record(RenderCommand::draw_quad, position, size, color, texture);
+
+    ReserveTris(6, 4, location);
 
     float tex_index = -1.f;
 
@@ -270,6 +360,9 @@ namespace Pixel {
       }
     }
 
+    // Full slots only break the batch when the texture is not already bound to one of them
+    if (tex_index == -1.f && data.texture_slot_index == pMaxTextures) FlushTris(FlushReason::texture_slots, location);
+
     if (tex_index == -1.f) {
       tex_index                                   = (float)data.texture_slot_index;
       data.texture_slots[data.texture_slot_index] = texture.getId();
@@ -314,12 +407,14 @@ namespace Pixel {
     data.stats.quads_drawn++;
   }
 
-  void Renderer::DrawTri(const glm::vec2 &v1, const glm::vec2 &v2, const glm::vec2 &v3, const glm::vec4 &color) {
-    if ((data.tri_index_count + 3) >= pMaxIndexCount || (data.tri_vertex_count + 3) >= pMaxVertexCount) {
-      EndTriBatch();
-      FlushTriBatch();
-      BeginTriBatch();
-    }
+  void Renderer::DrawTri(const glm::vec2 &v1,
+                         const glm::vec2 &v2,
+                         const glm::vec2 &v3,
+                         const glm::vec4 &color,
+                         const Location  &location) {
+    Record(RenderCommand::draw_tri, v1, v2, v3, color);
+
+    ReserveTris(3, 3, location);
 
     data.tri_vertex_buffer_current->position  = {v1.x, v1.y, 0.f};
     data.tri_vertex_buffer_current->color     = color;
@@ -349,13 +444,14 @@ namespace Pixel {
     data.stats.tris_drawn++;
   }
 
-  void Renderer::DrawCircle(const glm::vec2 &position, float radius, uint32_t segments, const glm::vec4 &color) {
-    if ((data.tri_index_count + segments * 3) >= pMaxIndexCount ||
-        (data.tri_vertex_count + segments + 1) >= pMaxVertexCount) {
-      EndTriBatch();
-      FlushTriBatch();
-      BeginTriBatch();
-    }
+  void Renderer::DrawCircle(const glm::vec2 &position,
+                            float            radius,
+                            uint32_t         segments,
+                            const glm::vec4 &color,
+                            const Location  &location) {
+    Record(RenderCommand::draw_circle, position, radius, segments, color);
+
+    ReserveTris(segments * 3, segments + 1, location);
 
     float inc = glm::two_pi<float>() / segments;
 
@@ -384,23 +480,24 @@ namespace Pixel {
     data.stats.circles_drawn++;
   }
 
-  void Renderer::DrawLine(const glm::vec2 &pos1, const glm::vec2 &pos2, const glm::vec4 &color) {
-    if ((data.line_index_count + 2) >= pMaxIndexCount || (data.line_vertex_count + 2) >= pMaxVertexCount) {
-      EndLineBatch();
-      FlushLineBatch();
-      BeginLineBatch();
-    }
+  void Renderer::DrawLine(const glm::vec2 &pos1,
+                          const glm::vec2 &pos2,
+                          const glm::vec4 &color,
+                          const Location  &location) {
+    Record(RenderCommand::draw_line, pos1, pos2, color);
 
-    data.line_vertex_buffer_current->position = {pos1.x, pos1.y, 0.f};
-    data.line_vertex_buffer_current->color    = color;
-    data.tri_vertex_buffer_current->tex_coord = {0.f, 0.f};
-    data.tri_vertex_buffer_current->tex_id    = 0;
+    ReserveLines(2, 2, location);
+
+    data.line_vertex_buffer_current->position  = {pos1.x, pos1.y, 0.f};
+    data.line_vertex_buffer_current->color     = color;
+    data.line_vertex_buffer_current->tex_coord = {0.f, 0.f};
+    data.line_vertex_buffer_current->tex_id    = 0;
     data.line_vertex_buffer_current++;
 
-    data.line_vertex_buffer_current->position = {pos2.x, pos2.y, 0.f};
-    data.line_vertex_buffer_current->color    = color;
-    data.tri_vertex_buffer_current->tex_coord = {0.f, 0.f};
-    data.tri_vertex_buffer_current->tex_id    = 0;
+    data.line_vertex_buffer_current->position  = {pos2.x, pos2.y, 0.f};
+    data.line_vertex_buffer_current->color     = color;
+    data.line_vertex_buffer_current->tex_coord = {0.f, 0.f};
+    data.line_vertex_buffer_current->tex_id    = 0;
     data.line_vertex_buffer_current++;
 
     data.line_index_buffer[data.line_index_count + 0] = 0 + data.line_vertex_count;
@@ -412,13 +509,14 @@ namespace Pixel {
     data.stats.lines_drawn++;
   }
 
-  void Renderer::DrawLine(const glm::vec2 &pos1, const glm::vec2 &pos2, float width, const glm::vec4 &color) {
-    if ((data.tri_index_count + 6) >= pMaxIndexCount || (data.tri_vertex_count + 4) >= pMaxVertexCount ||
-        data.texture_slot_index > (pMaxTextures - 1)) {
-      EndTriBatch();
-      FlushTriBatch();
-      BeginTriBatch();
-    }
+  void Renderer::DrawLine(const glm::vec2 &pos1,
+                          const glm::vec2 &pos2,
+                          float            width,
+                          const glm::vec4 &color,
+                          const Location  &location) {
+    Record(RenderCommand::draw_wide_line, pos1, pos2, width, color);
+
+    ReserveTris(6, 4, location);
 
     const glm::vec2 diff   = pos2 - pos1;
     const glm::vec2 offset = (width * diff) / (glm::length(diff) * 2);
@@ -461,35 +559,36 @@ namespace Pixel {
     data.stats.wide_lines_drawn++;
   }
 
-  void Renderer::OutlineQuad(const glm::vec2 &position, const glm::vec2 &size, const glm::vec4 &color) {
-    if ((data.line_index_count + 8) >= pMaxIndexCount || (data.line_vertex_count + 4) >= pMaxVertexCount) {
-      EndLineBatch();
-      FlushLineBatch();
-      BeginLineBatch();
-    }
+  void Renderer::OutlineQuad(const glm::vec2 &position,
+                             const glm::vec2 &size,
+                             const glm::vec4 &color,
+                             const Location  &location) {
+    Record(RenderCommand::outline_quad, position, size, color);
 
-    data.line_vertex_buffer_current->position = {position.x, position.y, 0.f};
-    data.line_vertex_buffer_current->color    = color;
-    data.tri_vertex_buffer_current->tex_coord = {0.f, 0.f};
-    data.tri_vertex_buffer_current->tex_id    = 0;
+    ReserveLines(8, 4, location);
+
+    data.line_vertex_buffer_current->position  = {position.x, position.y, 0.f};
+    data.line_vertex_buffer_current->color     = color;
+    data.line_vertex_buffer_current->tex_coord = {0.f, 0.f};
+    data.line_vertex_buffer_current->tex_id    = 0;
     data.line_vertex_buffer_current++;
 
-    data.line_vertex_buffer_current->position = {position.x, position.y + size.y, 0.f};
-    data.line_vertex_buffer_current->color    = color;
-    data.tri_vertex_buffer_current->tex_coord = {0.f, 0.f};
-    data.tri_vertex_buffer_current->tex_id    = 0;
+    data.line_vertex_buffer_current->position  = {position.x, position.y + size.y, 0.f};
+    data.line_vertex_buffer_current->color     = color;
+    data.line_vertex_buffer_current->tex_coord = {0.f, 0.f};
+    data.line_vertex_buffer_current->tex_id    = 0;
     data.line_vertex_buffer_current++;
 
-    data.line_vertex_buffer_current->position = {position.x + size.x, position.y + size.y, 0.f};
-    data.line_vertex_buffer_current->color    = color;
-    data.tri_vertex_buffer_current->tex_coord = {0.f, 0.f};
-    data.tri_vertex_buffer_current->tex_id    = 0;
+    data.line_vertex_buffer_current->position  = {position.x + size.x, position.y + size.y, 0.f};
+    data.line_vertex_buffer_current->color     = color;
+    data.line_vertex_buffer_current->tex_coord = {0.f, 0.f};
+    data.line_vertex_buffer_current->tex_id    = 0;
     data.line_vertex_buffer_current++;
 
-    data.line_vertex_buffer_current->position = {position.x + size.x, position.y, 0.f};
-    data.line_vertex_buffer_current->color    = color;
-    data.tri_vertex_buffer_current->tex_coord = {0.f, 0.f};
-    data.tri_vertex_buffer_current->tex_id    = 0;
+    data.line_vertex_buffer_current->position  = {position.x + size.x, position.y, 0.f};
+    data.line_vertex_buffer_current->color     = color;
+    data.line_vertex_buffer_current->tex_coord = {0.f, 0.f};
+    data.line_vertex_buffer_current->tex_id    = 0;
     data.line_vertex_buffer_current++;
 
     data.line_index_buffer[data.line_index_count + 0] = 0 + data.line_vertex_count;
@@ -514,7 +613,12 @@ namespace Pixel {
                             const glm::vec2 &v2,
                             const glm::vec2 &v3,
                             float            width,
-                            const glm::vec4 &color) {
+                            const glm::vec4 &color,
+                            const Location  &location) {
+    Record(RenderCommand::outline_tri, v1, v2, v3, width, color);
+
+    ReserveTris(18, 6, location);
+
     const float a = glm::length(v1 - v2);
     const float b = glm::length(v2 - v3);
     const float c = glm::length(v3 - v1);
@@ -599,7 +703,12 @@ namespace Pixel {
                            const glm::vec2 &v3,
                            float            width,
                            const glm::vec4 &inner_color,
-                           const glm::vec4 &outter_color) {
+                           const glm::vec4 &outter_color,
+                           const Location  &location) {
+    Record(RenderCommand::border_tri, v1, v2, v3, width, inner_color, outter_color);
+
+    ReserveTris(21, 9, location);
+
     const float a = glm::length(v1 - v2);
     const float b = glm::length(v2 - v3);
     const float c = glm::length(v3 - v1);
@@ -705,13 +814,11 @@ namespace Pixel {
                                float            radius,
                                uint32_t         segments,
                                float            width,
-                               const glm::vec4 &color) {
-    if ((data.tri_index_count + segments * 6) >= pMaxIndexCount ||
-        (data.tri_vertex_count + segments * 2) >= pMaxVertexCount) {
-      EndTriBatch();
-      FlushTriBatch();
-      BeginTriBatch();
-    }
+                               const glm::vec4 &color,
+                               const Location  &location) {
+    Record(RenderCommand::outline_circle, position, radius, segments, width, color);
+
+    ReserveTris(segments * 6, segments * 2, location);
 
     const float inc = glm::two_pi<float>() / segments;
     const float w   = width / std::cos(inc / 2);
@@ -755,13 +862,11 @@ namespace Pixel {
                               uint32_t         segments,
                               float            width,
                               const glm::vec4 &inner_color,
-                              const glm::vec4 &outter_color) {
-    if ((data.tri_index_count + segments * 9) >= pMaxIndexCount ||
-        (data.tri_vertex_count + segments * 3 + 1) >= pMaxVertexCount) {
-      EndTriBatch();
-      FlushTriBatch();
-      BeginTriBatch();
-    }
+                              const glm::vec4 &outter_color,
+                              const Location  &location) {
+    Record(RenderCommand::border_circle, position, radius, segments, width, inner_color, outter_color);
+
+    ReserveTris(segments * 9, segments * 3 + 1, location);
 
     const float inc = glm::two_pi<float>() / segments;
     const float w   = width / std::cos(inc / 2);
@@ -813,7 +918,7 @@ namespace Pixel {
     data.tri_vertex_buffer_current++;
 
     data.tri_vertex_count += (3 * segments + 1);
-    data.stats.circles_outlined++;
+    data.stats.circles_bordered++;
   }
 
   void Renderer::BorderSemicircle(const glm::vec2 &position,
@@ -823,13 +928,19 @@ namespace Pixel {
                                   uint32_t         segments,
                                   float            width,
                                   const glm::vec4 &inner_color,
-                                  const glm::vec4 &outter_color) {
-    if ((data.tri_index_count + segments * 9) >= pMaxIndexCount ||
-        (data.tri_vertex_count + segments * 3 + 4) >= pMaxVertexCount) {
-      EndTriBatch();
-      FlushTriBatch();
-      BeginTriBatch();
-    }
+                                  const glm::vec4 &outter_color,
+                                  const Location  &location) {
+    Record(RenderCommand::border_semicircle,
+           position,
+           radius,
+           start_angle,
+           end_angle,
+           segments,
+           width,
+           inner_color,
+           outter_color);
+
+    ReserveTris(segments * 9, segments * 3 + 4, location);
 
     const float inc          = (end_angle - start_angle) / segments;
     const float inner_radius = radius - (width / std::cos(inc / 2));
@@ -896,13 +1007,20 @@ namespace Pixel {
                                                     uint32_t         segments,
                                                     float            width,
                                                     const glm::vec4 &inner_color,
-                                                    const glm::vec4 &outter_color) {
-    if ((data.tri_index_count + segments * 9) >= pMaxIndexCount ||
-        (data.tri_vertex_count + segments * 3 + 4) >= pMaxVertexCount) {
-      EndTriBatch();
-      FlushTriBatch();
-      BeginTriBatch();
-    }
+                                                    const glm::vec4 &outter_color,
+                                                    const Location  &location) {
+    Record(RenderCommand::border_semicircle_custom_center_inside,
+           position,
+           center,
+           radius,
+           start_angle,
+           end_angle,
+           segments,
+           width,
+           inner_color,
+           outter_color);
+
+    ReserveTris(segments * 9, segments * 3 + 4, location);
 
     const float inc          = (end_angle - start_angle) / segments;
     const float inner_radius = radius - (width / std::cos(inc / 2));
@@ -969,13 +1087,20 @@ namespace Pixel {
                                                      uint32_t         segments,
                                                      float            width,
                                                      const glm::vec4 &inner_color,
-                                                     const glm::vec4 &outter_color) {
-    if ((data.tri_index_count + segments * 9) >= pMaxIndexCount ||
-        (data.tri_vertex_count + segments * 3 + 4) >= pMaxVertexCount) {
-      EndTriBatch();
-      FlushTriBatch();
-      BeginTriBatch();
-    }
+                                                     const glm::vec4 &outter_color,
+                                                     const Location  &location) {
+    Record(RenderCommand::border_semicircle_custom_center_outside,
+           position,
+           center,
+           radius,
+           start_angle,
+           end_angle,
+           segments,
+           width,
+           inner_color,
+           outter_color);
+
+    ReserveTris(segments * 9, segments * 3 + 4, location);
 
     const float inc          = (end_angle - start_angle) / segments;
     const float inner_radius = radius - (width / std::cos(inc / 2));
@@ -1034,16 +1159,147 @@ namespace Pixel {
     data.stats.semicircles_bordered++;
   }
 
-  void Renderer::SetViewProjection(const glm::mat4 &view_projection) { data.view_projection = view_projection; }
+  void Renderer::SetViewProjection(const glm::mat4 &view_projection) {
+    Record(RenderCommand::set_view_projection, view_projection);
+    data.view_projection = view_projection;
+  }
 
   void Renderer::SetTransform(const glm::vec3 &transform) {
+    Record(RenderCommand::set_transform, transform);
     data.transform = glm::translate(glm::mat4(1.f), transform);
   }
 
   void Renderer::UseCamera(const OrthographicCamera &camera) {
+    Record(RenderCommand::set_view_projection, camera.getViewProjectionMatrix());
     data.view_projection = camera.getViewProjectionMatrix();
   }
 
-  void                   Renderer::ResetStats() { data.stats = {}; }
-  const Renderer::Stats &Renderer::GetStats() { return data.stats; }
+  void Renderer::SetViewProjectionOverride(const glm::mat4 &view_projection) {
+    Record(RenderCommand::set_view_projection_override, view_projection);
+    data.view_projection_override     = view_projection;
+    data.has_view_projection_override = true;
+  }
+
+  void Renderer::ClearViewProjectionOverride() {
+    Record(RenderCommand::clear_view_projection_override);
+    data.has_view_projection_override = false;
+  }
+
+  void Renderer::ResetStats() {
+    const GpuTimings      gpu        = data.stats.gpu;
+    const GpuTimingWindow gpu_window = data.stats.gpu_window;
+
+    data.stats            = {};
+    data.stats.gpu        = gpu;
+    data.stats.gpu_window = gpu_window;
+  }
+
+  void Renderer::PublishGpuTimings(const GpuTimings &last, const GpuTimingWindow &window) {
+    data.gpu_published    = true;
+    data.stats.gpu        = last;
+    data.stats.gpu_window = window;
+  }
+
+  const Renderer::Stats &Renderer::GetStats() {
+    if (!data.gpu_published) {
+      data.stats.gpu        = gpu_timer.Last();
+      data.stats.gpu_window = gpu_timer.Window();
+    }
+
+    return data.stats;
+  }
+
+  void Renderer::SetDebugView(DebugView view) {
+    Record(RenderCommand::set_debug_view, view);
+    data.debug_view = view;
+  }
+
+  DebugView Renderer::GetDebugView() { return data.debug_view; }
+
+  void Renderer::BeginDebugView(const glm::uvec2 &size) {
+    Record(RenderCommand::begin_debug_view, size);
+
+    if (data.debug_view != DebugView::overdraw) return;
+
+    data.backend->BeginOverdraw(size);
+    data.overdraw_active = true;
+  }
+
+  void Renderer::EndDebugView(const Location &location) {
+    Record(RenderCommand::end_debug_view);
+
+    if (!data.overdraw_active) return;
+
+    FlushPending(location);
+
+    data.backend->EndOverdraw();
+    data.overdraw_active = false;
+  }
+
+  void Renderer::NewFrame() {
+    data.debug_batch       = 0;
+    data.flush_log_current = 1 - data.flush_log_current;
+
+    FlushLog &log = data.flush_logs[data.flush_log_current];
+    std::fill_n(log.counts, (size_t)FlushReason::count, 0u);
+    log.total   = 0;
+    log.dropped = 0;
+
+    if (data.recorder) data.recorder->NewFrame();
+  }
+
+  const FlushLog &Renderer::LastFrameFlushes() { return data.flush_logs[1 - data.flush_log_current]; }
+
+  uint32_t Renderer::LastFrameFlushSites(FlushSite *sites, uint32_t max) {
+    const FlushLog &log   = LastFrameFlushes();
+    const uint32_t  count = std::min(log.total, FlushLog::pMaxEvents);
+    uint32_t        found = 0;
+
+    // A few hundred events at most, a linear search per event is cheaper than hashing the locations
+    for (uint32_t i = 0; i < count; i++) {
+      const FlushEvent &event = log.events[i];
+      FlushSite        *site  = nullptr;
+
+      for (uint32_t j = 0; j < found; j++) {
+        if (sites[j].reason == event.reason && sites[j].lines == event.lines &&
+            sites[j].location.line() == event.location.line() &&
+            std::strcmp(sites[j].location.file_name(), event.location.file_name()) == 0) {
+          site = &sites[j];
+          break;
+        }
+      }
+
+      if (site == nullptr) {
+        if (found == max) continue;
+        site  = &sites[found++];
+        *site = {event.reason, event.lines, 0, event.location};
+      }
+
+      site->count++;
+    }
+
+    std::sort(sites, sites + found, [](const FlushSite &a, const FlushSite &b) { return a.count > b.count; });
+    return found;
+  }
+
+  void Renderer::DumpFlushes(std::ostream &out) {
+    const FlushLog &log = LastFrameFlushes();
+
+    out << "Batch flushes last frame: " << log.total;
+    for (uint32_t reason = 0; reason < (uint32_t)FlushReason::count; reason++) {
+      out << (reason == 0 ? " (" : ", ") << FlushReasonName((FlushReason)reason) << " " << log.counts[reason];
+    }
+    out << ")\n";
+
+    if (log.dropped > 0) out << "  " << log.dropped << " flushes past the event limit have no call site\n";
+
+    FlushSite      sites[64];
+    const uint32_t count = LastFrameFlushSites(sites, 64);
+
+    for (uint32_t i = 0; i < count; i++) {
+      out << "  " << sites[i].count << "x " << (sites[i].lines ? "lines " : "tris ") << FlushReasonName(sites[i].reason)
+          << " at " << sites[i].location.file_name() << ":" << sites[i].location.line() << " ("
+          << sites[i].location.function_name() << ")\n";
+    }
+  }
 }  // namespace Pixel
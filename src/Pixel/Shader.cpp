@@ -23,16 +23,19 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 namespace Pixel {
   ShaderProgram::ShaderProgram() {};
 
-  void ShaderProgram::LoadFromInlineCode(const std::string& vertex_code, const std::string& fragment_code) {
-    const GLchar* vertex_gl_code   = vertex_code.c_str();
-    const GLchar* fragment_gl_code = fragment_code.c_str();
+  void ShaderProgram::LoadFromInlineCode(std::string_view vertex_code, std::string_view fragment_code) {
+    const GLchar* vertex_gl_code   = vertex_code.data();
+    const GLchar* fragment_gl_code = fragment_code.data();
+
+    const GLint vertex_gl_length   = (GLint)vertex_code.size();
+    const GLint fragment_gl_length = (GLint)fragment_code.size();
 
     GLuint vertex, fragment;
     GLint  success;
     GLchar infoLog[512];
 
     vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vertex_gl_code, NULL);
+    glShaderSource(vertex, 1, &vertex_gl_code, &vertex_gl_length);
     glCompileShader(vertex);
 
     glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
@@ -42,7 +45,7 @@ namespace Pixel {
     }
 
     fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fragment_gl_code, NULL);
+    glShaderSource(fragment, 1, &fragment_gl_code, &fragment_gl_length);
     glCompileShader(fragment);
 
     glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
@@ -88,6 +91,11 @@ namespace Pixel {
     LoadFromInlineCode(vertex_stream.str(), fragment_stream.str());
   }
 
+  void ShaderProgram::Release() {
+    if (pProgram != 0) glDeleteProgram(pProgram);
+    pProgram = 0;
+  }
+
   GLuint ShaderProgram::getProgram() { return pProgram; }
   void   ShaderProgram::Use() { glUseProgram(pProgram); }
 }
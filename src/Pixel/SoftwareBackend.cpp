@@ -0,0 +1,519 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/SoftwareBackend.hpp"
+#include "Pixel/RenderTarget.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Util/Logger.hpp"
+#include "Util/Profiler.hpp"
+
+namespace Pixel {
+  static void Fill(std::vector<uint8_t>& color, const glm::vec4& value) {
+    const glm::vec4 clamped = glm::round(glm::clamp(value, 0.f, 1.f) * 255.f);
+    const uint8_t   rgba[4] = {(uint8_t)clamped.x, (uint8_t)clamped.y, (uint8_t)clamped.z, (uint8_t)clamped.w};
+
+    for (size_t i = 0; i < color.size(); i += 4) std::memcpy(&color[i], rgba, 4);
+  }
+
+  static glm::vec4 Fetch(const TextureImage& image, int32_t x, int32_t y) {
+    x = std::clamp(x, 0, (int32_t)image.size.x - 1);
+    y = std::clamp(y, 0, (int32_t)image.size.y - 1);
+
+    const uint8_t* texel = &image.pixels[((size_t)y * image.size.x + x) * 4];
+    return glm::vec4(texel[0], texel[1], texel[2], texel[3]) / 255.f;
+  }
+
+  // GL_LINEAR with GL_CLAMP_TO_EDGE on the base level
+  static glm::vec4 Sample(const TextureImage& image, const glm::vec2& tex_coord) {
+    const glm::vec2 texel = tex_coord * glm::vec2(image.size) - .5f;
+    const glm::vec2 base  = glm::floor(texel);
+    const glm::vec2 f     = texel - base;
+
+    const int32_t x = (int32_t)base.x, y = (int32_t)base.y;
+
+    const glm::vec4 bottom = glm::mix(Fetch(image, x, y), Fetch(image, x + 1, y), f.x);
+    const glm::vec4 top    = glm::mix(Fetch(image, x, y + 1), Fetch(image, x + 1, y + 1), f.x);
+
+    return glm::mix(bottom, top, f.y);
+  }
+
+  // Same ramp as overdraw_fragment_shader_code
+  static glm::vec3 OverdrawColor(uint32_t layers) {
+    static const glm::vec3 ramp[6] = {glm::vec3(0.f),
+                                      glm::vec3(0.f, .1f, .7f),
+                                      glm::vec3(0.f, .7f, .9f),
+                                      glm::vec3(.1f, .9f, .2f),
+                                      glm::vec3(1.f, .9f, 0.f),
+                                      glm::vec3(1.f, .1f, .1f)};
+
+    const float   t = std::clamp(layers < 1 ? 0.f : 1.f + std::log2((float)layers), 0.f, 5.f);
+    const int32_t i = std::min((int32_t)t, 4);
+
+    return glm::mix(ramp[i], ramp[i + 1], t - (float)i);
+  }
+
+  void SoftwareBackend::Create(const glm::uvec2& size, uint32_t threads) {
+    pThreadCount = threads != 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+    pRanges      = std::make_unique<TileRange[]>(pThreadCount);
+
+    Resize(size);
+  }
+
+  void SoftwareBackend::Resize(const glm::uvec2& size) {
+    Finish();
+
+    pFramebuffer.size = glm::max(size, glm::uvec2(1, 1));
+    pFramebuffer.color.assign((size_t)pFramebuffer.size.x * pFramebuffer.size.y * 4, 0);
+
+    if (pSurface == &pFramebuffer) pResizeTiles();
+  }
+
+  void SoftwareBackend::Init() {
+    if (!pRanges) Logger::Die("SoftwareBackend::Create must come before Renderer::Init");
+
+    pStopping = false;
+
+    for (uint32_t i = 1; i < pThreadCount; i++) {
+      pWorkers.emplace_back(&SoftwareBackend::pWorker, this, i);
+    }
+  }
+
+  void SoftwareBackend::Delete() {
+    Finish();
+
+    {
+      std::lock_guard<std::mutex> lock(pMutex);
+      pStopping = true;
+    }
+
+    pWorkReady.notify_all();
+
+    for (auto& worker : pWorkers) worker.join();
+    pWorkers.clear();
+
+    pTargets.clear();
+    pTargetStack.clear();
+    pSurface         = &pFramebuffer;
+    pOverdrawSurface = nullptr;
+  }
+
+  void SoftwareBackend::Upload(const BatchUpload& batch) {
+    auto& upload    = pUploads[batch.lines];
+    upload.vertices = batch.vertices;
+    upload.indices  = batch.indices;
+    upload.matrix   = *batch.view_projection * *batch.transform;
+  }
+
+  void SoftwareBackend::Draw(const BatchDraw& draw) {
+    PIXEL_PROFILE_SCOPE("SoftwareBackend::Draw");
+
+    const auto&     upload = pUploads[draw.lines];
+    const glm::vec2 half   = glm::vec2(pSurface->size) * .5f;
+
+    const TextureImage* textures[Renderer::pMaxTextures] = {};
+
+    for (uint32_t i = 0; i < std::min(draw.texture_count, Renderer::pMaxTextures); i++) {
+      const auto texture = pTextures.find(draw.textures[i]);
+      if (texture != pTextures.end()) textures[i] = &texture->second;
+    }
+
+    // The vertex shader, with the viewport transform
+    auto transform = [&](uint32_t index) {
+      const Vertex&   vertex = upload.vertices[index];
+      const glm::vec4 clip   = upload.matrix * glm::vec4(vertex.position, 1.f);
+
+      return ShadedVertex {(glm::vec2(clip) / clip.w + 1.f) * half, vertex.color, vertex.tex_coord};
+    };
+
+    const uint32_t stride    = draw.lines ? 2 : 3;
+    const bool     wireframe = draw.debug_view == DebugView::wireframe && !draw.lines;
+
+    for (uint32_t i = 0; i + stride <= draw.index_count; i += stride) {
+      Primitive primitive   = {};
+      primitive.line        = draw.lines;
+      primitive.debug_view  = draw.debug_view;
+      primitive.debug_color = draw.debug_color;
+
+      const int32_t slot = (int32_t)upload.vertices[upload.indices[i]].tex_id;
+      if (slot >= 0 && slot < (int32_t)Renderer::pMaxTextures) primitive.texture = textures[slot];
+
+      for (uint32_t v = 0; v < stride; v++) primitive.vertices[v] = transform(upload.indices[i + v]);
+
+      if (!wireframe) {
+        glm::vec2 min = primitive.vertices[0].position, max = min;
+
+        for (uint32_t v = 1; v < stride; v++) {
+          min = glm::min(min, primitive.vertices[v].position);
+          max = glm::max(max, primitive.vertices[v].position);
+        }
+
+        pBin(primitive, min, max);
+        continue;
+      }
+
+      // Like glPolygonMode(GL_LINE), every edge is drawn as a line of its own
+      const Primitive triangle = primitive;
+      primitive.line           = true;
+
+      for (uint32_t v = 0; v < 3; v++) {
+        primitive.vertices[0] = triangle.vertices[v];
+        primitive.vertices[1] = triangle.vertices[(v + 1) % 3];
+
+        pBin(primitive,
+             glm::min(primitive.vertices[0].position, primitive.vertices[1].position),
+             glm::max(primitive.vertices[0].position, primitive.vertices[1].position));
+      }
+    }
+  }
+
+  void SoftwareBackend::pBin(const Primitive& primitive, const glm::vec2& min, const glm::vec2& max) {
+    const glm::ivec2 size = pSurface->size;
+
+    // Lines are widened by a pixel so the one their center rounds into is never left out
+    const float      margin = primitive.line ? 1.f : 0.f;
+    const glm::ivec2 low    = glm::ivec2(glm::floor(min - margin));
+    const glm::ivec2 high   = glm::ivec2(glm::floor(max + margin));
+
+    if (high.x < 0 || high.y < 0 || low.x >= size.x || low.y >= size.y) return;
+
+    if (pPrimitives.size() == pMaxPrimitives) Finish();
+
+    const uint32_t   index      = (uint32_t)pPrimitives.size();
+    const glm::ivec2 first_tile = glm::max(low, glm::ivec2(0)) / (int32_t)pTileSize;
+    const glm::ivec2 last_tile  = glm::min(high, size - 1) / (int32_t)pTileSize;
+
+    pPrimitives.push_back(primitive);
+
+    for (int32_t y = first_tile.y; y <= last_tile.y; y++) {
+      for (int32_t x = first_tile.x; x <= last_tile.x; x++) {
+        const uint32_t tile = y * pTileCount.x + x;
+
+        if (pBins[tile].empty()) pActiveTiles.push_back(tile);
+        pBins[tile].push_back(index);
+      }
+    }
+  }
+
+  void SoftwareBackend::pResizeTiles() {
+    pTileCount = (pSurface->size + pTileSize - 1u) / pTileSize;
+    pBins.resize(pTileCount.x * pTileCount.y);
+  }
+
+  void SoftwareBackend::Finish() {
+    if (pActiveTiles.empty()) {
+      pPrimitives.clear();
+      return;
+    }
+
+    PIXEL_PROFILE_SCOPE("SoftwareBackend::Finish");
+
+    // Every thread starts on its own run of neighbouring tiles and steals from the others once that runs out
+    const uint32_t threads = Threads();
+    const uint32_t tiles   = (uint32_t)pActiveTiles.size();
+
+    for (uint32_t i = 0; i < threads; i++) {
+      pRanges[i].next = tiles * i / threads;
+      pRanges[i].end  = tiles * (i + 1) / threads;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(pMutex);
+      pGeneration++;
+      pBusy = (uint32_t)pWorkers.size();
+    }
+
+    pWorkReady.notify_all();
+    pRasterizeTiles(0);
+
+    {
+      std::unique_lock<std::mutex> lock(pMutex);
+      pWorkDone.wait(lock, [this] { return pBusy == 0; });
+    }
+
+    for (uint32_t tile : pActiveTiles) pBins[tile].clear();
+
+    pActiveTiles.clear();
+    pPrimitives.clear();
+  }
+
+  void SoftwareBackend::pWorker(uint32_t worker) {
+    PIXEL_PROFILE_THREAD("Raster worker");
+
+    uint64_t generation = 0;
+
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(pMutex);
+        pWorkReady.wait(lock, [&] { return pStopping || pGeneration != generation; });
+        if (pStopping) return;
+
+        generation = pGeneration;
+      }
+
+      pRasterizeTiles(worker);
+
+      {
+        std::lock_guard<std::mutex> lock(pMutex);
+        if (--pBusy == 0) pWorkDone.notify_one();
+      }
+    }
+  }
+
+  void SoftwareBackend::pRasterizeTiles(uint32_t worker) {
+    const uint32_t threads = Threads();
+
+    for (uint32_t i = 0; i < threads; i++) {
+      TileRange& range = pRanges[(worker + i) % threads];
+
+      for (uint32_t index = range.next++; index < range.end; index = range.next++) {
+        pRasterizeTile(pActiveTiles[index]);
+      }
+    }
+  }
+
+  void SoftwareBackend::pRasterizeTile(uint32_t tile) {
+    const glm::ivec2 origin = glm::ivec2(tile % pTileCount.x, tile / pTileCount.x) * (int32_t)pTileSize;
+    const glm::ivec2 end    = glm::min(origin + (int32_t)pTileSize, glm::ivec2(pSurface->size));
+    const glm::ivec4 bounds = {origin.x, origin.y, end.x, end.y};
+
+    for (uint32_t index : pBins[tile]) {
+      const Primitive& primitive = pPrimitives[index];
+
+      if (primitive.line) {
+        pRasterizeLine(primitive, bounds);
+
+      } else {
+        pRasterizeTriangle(primitive, bounds);
+      }
+    }
+  }
+
+  void SoftwareBackend::pRasterizeTriangle(const Primitive& primitive, const glm::ivec4& bounds) {
+    const ShadedVertex* v = primitive.vertices;
+
+    float area = (v[1].position.x - v[0].position.x) * (v[2].position.y - v[0].position.y) -
+                 (v[1].position.y - v[0].position.y) * (v[2].position.x - v[0].position.x);
+
+    if (area == 0.f) return;
+
+    // Edge i is the one opposite vertex i, flipped with the winding so every edge function is positive inside. Pixels
+    // exactly on an edge go to one side only, so triangles sharing it do not blend that pixel twice.
+    struct {
+      float a, b, c;
+      bool  inclusive;
+    } edges[3];
+
+    const float sign = area < 0.f ? -1.f : 1.f;
+    area *= sign;
+
+    for (uint32_t i = 0; i < 3; i++) {
+      const glm::vec2& p0 = v[(i + 1) % 3].position;
+      const glm::vec2& p1 = v[(i + 2) % 3].position;
+
+      edges[i].a         = (p0.y - p1.y) * sign;
+      edges[i].b         = (p1.x - p0.x) * sign;
+      edges[i].c         = (p0.x * p1.y - p0.y * p1.x) * sign;
+      edges[i].inclusive = edges[i].a > 0.f || (edges[i].a == 0.f && edges[i].b < 0.f);
+    }
+
+    const glm::vec2 min = glm::min(v[0].position, glm::min(v[1].position, v[2].position));
+    const glm::vec2 max = glm::max(v[0].position, glm::max(v[1].position, v[2].position));
+
+    const int32_t x0 = std::max(bounds.x, (int32_t)std::floor(min.x));
+    const int32_t y0 = std::max(bounds.y, (int32_t)std::floor(min.y));
+    const int32_t x1 = std::min(bounds.z, (int32_t)std::ceil(max.x));
+    const int32_t y1 = std::min(bounds.w, (int32_t)std::ceil(max.y));
+
+    const float inverse_area = 1.f / area;
+
+    for (int32_t y = y0; y < y1; y++) {
+      const float py = y + .5f;
+
+      // Four pixels per step with no dependency between lanes, so the edge tests compile to vector instructions
+      for (int32_t x = x0; x < x1; x += 4) {
+        float w[3][4];
+        bool  covered[4];
+
+        for (int32_t lane = 0; lane < 4; lane++) {
+          const float px = x + lane + .5f;
+          covered[lane]  = x + lane < x1;
+
+          for (uint32_t e = 0; e < 3; e++) {
+            w[e][lane] = edges[e].a * px + edges[e].b * py + edges[e].c;
+            covered[lane] &= w[e][lane] > 0.f || (w[e][lane] == 0.f && edges[e].inclusive);
+          }
+        }
+
+        for (int32_t lane = 0; lane < 4; lane++) {
+          if (!covered[lane]) continue;
+
+          const float b0 = w[0][lane] * inverse_area, b1 = w[1][lane] * inverse_area, b2 = w[2][lane] * inverse_area;
+
+          pShade(primitive,
+                 x + lane,
+                 y,
+                 v[0].color * b0 + v[1].color * b1 + v[2].color * b2,
+                 v[0].tex_coord * b0 + v[1].tex_coord * b1 + v[2].tex_coord * b2);
+        }
+      }
+    }
+  }
+
+  void SoftwareBackend::pRasterizeLine(const Primitive& primitive, const glm::ivec4& bounds) {
+    const ShadedVertex& v0 = primitive.vertices[0];
+    const ShadedVertex& v1 = primitive.vertices[1];
+
+    const glm::vec2 delta   = v1.position - v0.position;
+    const bool      x_major = std::abs(delta.x) >= std::abs(delta.y);
+    const int32_t   major   = x_major ? 0 : 1;
+    const int32_t   minor   = 1 - major;
+
+    if (delta[major] == 0.f) return;
+
+    // One pixel per column (or row) whose center the line passes, with the far end left open like GL_LINES
+    const float low  = std::min(v0.position[major], v1.position[major]);
+    const float high = std::max(v0.position[major], v1.position[major]);
+
+    const int32_t first = std::max((int32_t)std::ceil(low - .5f), x_major ? bounds.x : bounds.y);
+    const int32_t last  = std::min((int32_t)std::ceil(high - .5f), x_major ? bounds.z : bounds.w);
+
+    for (int32_t i = first; i < last; i++) {
+      const float   t = (i + .5f - v0.position[major]) / delta[major];
+      const int32_t j = (int32_t)std::floor(v0.position[minor] + t * delta[minor]);
+
+      if (j < (x_major ? bounds.y : bounds.x) || j >= (x_major ? bounds.w : bounds.z)) continue;
+
+      pShade(primitive,
+             x_major ? i : j,
+             x_major ? j : i,
+             glm::mix(v0.color, v1.color, t),
+             glm::mix(v0.tex_coord, v1.tex_coord, t));
+    }
+  }
+
+  void SoftwareBackend::pShade(
+      const Primitive& primitive, int32_t x, int32_t y, const glm::vec4& color, const glm::vec2& tex_coord) {
+    const size_t pixel = (size_t)y * pSurface->size.x + x;
+
+    if (pSurface == pOverdrawSurface) {
+      if (pOverdraw[pixel] != UINT16_MAX) pOverdraw[pixel]++;
+      return;
+    }
+
+    glm::vec4 fragment = primitive.texture ? Sample(*primitive.texture, tex_coord) * color : color;
+
+    if (primitive.debug_view == DebugView::batches) {
+      fragment = glm::vec4(glm::mix(glm::vec3(fragment), primitive.debug_color, .75f), std::max(fragment.w, .5f));
+
+    } else if (primitive.debug_view == DebugView::wireframe) {
+      fragment = glm::vec4(glm::vec3(color), 1.f);
+    }
+
+    // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) on every channel, into an 8 bit target
+    uint8_t*        target      = &pSurface->color[pixel * 4];
+    const float     alpha       = std::clamp(fragment.w, 0.f, 1.f);
+    const glm::vec4 destination = glm::vec4(target[0], target[1], target[2], target[3]) / 255.f;
+    const glm::vec4 blended     = glm::clamp(fragment, 0.f, 1.f) * alpha + destination * (1.f - alpha);
+
+    for (int32_t c = 0; c < 4; c++) target[c] = (uint8_t)(blended[c] * 255.f + .5f);
+  }
+
+  void SoftwareBackend::BeginTarget(RenderTarget& target, bool clear, const glm::vec4& clear_color) {
+    Finish();
+
+    Surface& surface = pTargets[&target];
+
+    if (surface.size != target.Size()) {
+      surface.size = target.Size();
+      surface.color.assign((size_t)surface.size.x * surface.size.y * 4, 0);
+    }
+
+    if (clear) Fill(surface.color, clear_color);
+
+    pTargetStack.push_back(pSurface);
+    pSurface = &surface;
+    pResizeTiles();
+  }
+
+  void SoftwareBackend::EndTarget(RenderTarget& target) {
+    Finish();
+
+    // Lets later draws sample the target like they would its GL texture
+    if (target.getId() != 0) pTextures[target.getId()] = TextureImage {pSurface->size, pSurface->color};
+
+    pSurface = pTargetStack.back();
+    pTargetStack.pop_back();
+    pResizeTiles();
+  }
+
+  void SoftwareBackend::BeginOverdraw(const glm::uvec2& size) {
+    Finish();
+
+    pOverdraw.assign((size_t)pSurface->size.x * pSurface->size.y, 0);
+    pOverdrawSurface = pSurface;
+  }
+
+  void SoftwareBackend::EndOverdraw() {
+    Finish();
+
+    Surface* surface = pOverdrawSurface;
+    pOverdrawSurface = nullptr;
+
+    if (!surface) return;
+
+    for (size_t pixel = 0; pixel < pOverdraw.size(); pixel++) {
+      const glm::vec3 color = glm::round(OverdrawColor(pOverdraw[pixel]) * 255.f);
+      uint8_t*        rgba  = &surface->color[pixel * 4];
+
+      rgba[0] = (uint8_t)color.x;
+      rgba[1] = (uint8_t)color.y;
+      rgba[2] = (uint8_t)color.z;
+      rgba[3] = 255;
+    }
+  }
+
+  void SoftwareBackend::Clear(const glm::vec4& color) {
+    Finish();
+    Fill(pFramebuffer.color, color);
+  }
+
+  const uint8_t* SoftwareBackend::Pixels() {
+    Finish();
+    return pFramebuffer.color.data();
+  }
+
+  Texture SoftwareBackend::CreateTexture(TextureImage image) {
+    Texture texture;
+    texture.pId = pNextTextureId++;
+
+    pTextures[texture.pId] = std::move(image);
+    return texture;
+  }
+
+  void SoftwareBackend::SetTexture(const Texture& texture, TextureImage image) {
+    Finish();
+    pTextures[texture.getId()] = std::move(image);
+  }
+
+  void SoftwareBackend::ReleaseTexture(Texture& texture) {
+    Finish();
+    pTextures.erase(texture.pId);
+
+    texture.pId = 0;
+  }
+}
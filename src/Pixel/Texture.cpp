@@ -17,23 +17,94 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include "Pixel/Texture.hpp"
+#include "Pixel/TextureCompression.hpp"
+#include "Pixel/TextureMips.hpp"
+#include "Util/Logger.hpp"
 
 namespace Pixel {
-  void Texture::Load(const std::string& filepath) {
+  std::atomic<uint64_t> Texture::pAllocatedBytes {0};
+
+  static GLenum TextureInternalFormat(TextureFormat format) {
+    switch (format) {
+      case TextureFormat::bc1:
+        return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+
+      case TextureFormat::bc3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+      case TextureFormat::bc7:
+        return GL_COMPRESSED_RGBA_BPTC_UNORM;
+
+      default:
+        return GL_RGBA8;
+    }
+  }
+
+  // In 64 bits, a 32768x32768 rgba8 level alone is already 4 GiB
+  uint64_t TextureLevelSize(TextureFormat format, const glm::uvec2& size) {
+    const uint64_t blocks = (uint64_t)((size.x + 3) / 4) * ((size.y + 3) / 4);
+
+    switch (format) {
+      case TextureFormat::bc1:
+        return blocks * 8;
+
+      case TextureFormat::bc3:
+      case TextureFormat::bc7:
+        return blocks * 16;
+
+      default:
+        return (uint64_t)size.x * size.y * 4;
+    }
+  }
+
+  glm::uvec2 TextureLevelDimensions(const glm::uvec2& size, uint32_t level) {
+    return {std::max(size.x >> level, 1u), std::max(size.y >> level, 1u)};
+  }
+
+  void Texture::Load(const std::string& filepath, const TextureOptions& options) {
     int32_t width, height, size;
 
     stbi_set_flip_vertically_on_load(1);
     auto* data = stbi_load(filepath.c_str(), &width, &height, &size, STBI_rgb_alpha);
+    if (!data) Logger::Die("Cannot load texture " + filepath + ": " + stbi_failure_reason());
 
-    glCreateTextures(GL_TEXTURE_2D, 1, &pId);
-    glBindTexture(GL_TEXTURE_2D, pId);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    TextureImage base;
+    base.size = {(uint32_t)width, (uint32_t)height};
+
+    if (options.mips == MipFilter::gpu && options.format == TextureFormat::rgba8) {
+      pCreate(base.size, TextureFormat::rgba8, MipLevelCount(base.size));
+      glTextureSubImage2D(pId, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+      glGenerateTextureMipmap(pId);
 
+      stbi_image_free(data);
+      return;
+    }
+
+    base.pixels.assign(data, data + width * height * 4);
     stbi_image_free(data);
+
+    // Compressed levels cannot be generated by the driver, so a gpu request falls back to the CPU box filter there
+    std::vector<TextureImage> chain;
+
+    if (options.mips == MipFilter::none) {
+      chain.push_back(std::move(base));
+
+    } else {
+      chain = GenerateMipChain(base, options.mips == MipFilter::kaiser ? MipFilter::kaiser : MipFilter::box);
+    }
+
+    std::vector<std::vector<uint8_t>> encoded;
+    std::vector<TextureLevel>         levels;
+
+    encoded.reserve(chain.size());
+    levels.reserve(chain.size());
+
+    for (const auto& level : chain) {
+      encoded.push_back(CompressTexture(level, options.format));
+      levels.push_back({encoded.back().data(), (uint32_t)encoded.back().size()});
+    }
+
+    Load({(uint32_t)width, (uint32_t)height}, options.format, levels.data(), (uint32_t)levels.size());
   }
 
   void Texture::Load(const glm::vec4& color) {
@@ -44,10 +115,60 @@ namespace Pixel {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, 1, 1, 0, GL_RGBA, GL_FLOAT, &color[0]);
+
+    pTrackMemory(sizeof(glm::vec4));
+  }
+
+  void Texture::Load(const glm::uvec2&   size,
+                     TextureFormat       format,
+                     const TextureLevel* levels,
+                     uint32_t            level_count) {
+    const GLenum internal_format = TextureInternalFormat(format);
+
+    pCreate(size, format, level_count);
+
+    for (uint32_t level = 0; level < level_count; level++) {
+      const glm::uvec2 level_size = TextureLevelDimensions(size, level);
+
+      if (format == TextureFormat::rgba8) {
+        glTextureSubImage2D(
+            pId, level, 0, 0, level_size.x, level_size.y, GL_RGBA, GL_UNSIGNED_BYTE, levels[level].data);
+
+      } else {
+        glCompressedTextureSubImage2D(
+            pId, level, 0, 0, level_size.x, level_size.y, internal_format, levels[level].size, levels[level].data);
+      }
+    }
+  }
+
+  void Texture::pCreate(const glm::uvec2& size, TextureFormat format, uint32_t level_count) {
+    glCreateTextures(GL_TEXTURE_2D, 1, &pId);
+    glTextureParameteri(pId, GL_TEXTURE_MIN_FILTER, level_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTextureParameteri(pId, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(pId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(pId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(pId, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+    glTextureStorage2D(pId, level_count, TextureInternalFormat(format), size.x, size.y);
+
+    uint64_t bytes = 0;
+    for (uint32_t level = 0; level < level_count; level++) {
+      bytes += TextureLevelSize(format, TextureLevelDimensions(size, level));
+    }
+
+    pTrackMemory(bytes);
+  }
+
+  void Texture::pTrackMemory(uint64_t bytes) {
+    pAllocatedBytes += bytes;
+    pMemoryBytes += bytes;
   }
 
   void Texture::Release() {
     if (pId != 0) glDeleteTextures(1, &pId);
+
+    pAllocatedBytes -= pMemoryBytes;
+    pMemoryBytes = 0;
+    pId          = 0;
   }
 
   GLuint Texture::getId() const { return pId; }
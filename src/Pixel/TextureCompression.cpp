@@ -0,0 +1,327 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/TextureCompression.hpp"
+#include "Pixel/JobSystem.hpp"
+
+namespace Pixel {
+  static constexpr uint8_t bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+  struct BitWriter {
+    uint8_t* data     = nullptr;
+    uint32_t position = 0;
+
+    void Write(uint32_t value, uint32_t bits) {
+      for (uint32_t i = 0; i < bits; i++, position++) {
+        if ((value >> i) & 1) data[position >> 3] |= (uint8_t)(1 << (position & 7));
+      }
+    }
+  };
+
+  static uint32_t Distance(const uint8_t* a, const uint8_t* b, uint32_t channels) {
+    uint32_t distance = 0;
+
+    for (uint32_t c = 0; c < channels; c++) {
+      const int32_t diff = (int32_t)a[c] - (int32_t)b[c];
+      distance += diff * diff;
+    }
+
+    return distance;
+  }
+
+  // Bounding box endpoints, with each channel flipped to follow the sign of its covariance with the dominant channel,
+  // which keeps diagonal gradients that run "against" the box diagonal from collapsing to a flat color.
+  static void FindEndpoints(const uint8_t (&texels)[16][4],
+                            uint32_t channels,
+                            bool     skip_transparent,
+                            uint8_t (&low)[4],
+                            uint8_t (&high)[4]) {
+    uint8_t  minimum[4] = {255, 255, 255, 255};
+    uint8_t  maximum[4] = {0, 0, 0, 0};
+    float    mean[4]    = {};
+    uint32_t count      = 0;
+
+    for (uint32_t i = 0; i < 16; i++) {
+      if (skip_transparent && texels[i][3] < 128) continue;
+
+      for (uint32_t c = 0; c < channels; c++) {
+        minimum[c] = std::min(minimum[c], texels[i][c]);
+        maximum[c] = std::max(maximum[c], texels[i][c]);
+        mean[c] += texels[i][c];
+      }
+
+      count++;
+    }
+
+    if (count == 0) {
+      std::fill_n(low, 4, 0);
+      std::fill_n(high, 4, 0);
+      return;
+    }
+
+    uint32_t dominant = 0;
+    for (uint32_t c = 0; c < channels; c++) {
+      mean[c] /= count;
+      if (maximum[c] - minimum[c] > maximum[dominant] - minimum[dominant]) dominant = c;
+    }
+
+    for (uint32_t c = 0; c < channels; c++) {
+      float covariance = 0.f;
+
+      for (uint32_t i = 0; i < 16; i++) {
+        if (skip_transparent && texels[i][3] < 128) continue;
+        covariance += (texels[i][c] - mean[c]) * (texels[i][dominant] - mean[dominant]);
+      }
+
+      const uint8_t inset = (uint8_t)((maximum[c] - minimum[c]) / 16);
+
+      low[c]  = covariance < 0.f ? maximum[c] - inset : minimum[c] + inset;
+      high[c] = covariance < 0.f ? minimum[c] + inset : maximum[c] - inset;
+    }
+
+    for (uint32_t c = channels; c < 4; c++) {
+      low[c]  = 255;
+      high[c] = 255;
+    }
+  }
+
+  static uint16_t To565(const uint8_t* color) {
+    return (uint16_t)((((color[0] * 31 + 127) / 255) << 11) | (((color[1] * 63 + 127) / 255) << 5) |
+                      ((color[2] * 31 + 127) / 255));
+  }
+
+  static void From565(uint16_t packed, uint8_t* color) {
+    const uint8_t r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+
+    color[0] = (uint8_t)((r << 3) | (r >> 2));
+    color[1] = (uint8_t)((g << 2) | (g >> 4));
+    color[2] = (uint8_t)((b << 3) | (b >> 2));
+    color[3] = 255;
+  }
+
+  static void EncodeColorBlock(const uint8_t (&texels)[16][4], uint8_t* block, bool punch_through) {
+    bool has_transparent = false;
+    if (punch_through) {
+      for (uint32_t i = 0; i < 16; i++) has_transparent |= texels[i][3] < 128;
+    }
+
+    uint8_t low[4], high[4];
+    FindEndpoints(texels, 3, has_transparent, low, high);
+
+    uint16_t color0 = To565(high);
+    uint16_t color1 = To565(low);
+
+    if (has_transparent ? color0 > color1 : color0 < color1) std::swap(color0, color1);
+
+    uint8_t palette[4][4];
+    From565(color0, palette[0]);
+    From565(color1, palette[1]);
+
+    if (has_transparent) {
+      for (uint32_t c = 0; c < 3; c++) palette[2][c] = (uint8_t)((palette[0][c] + palette[1][c]) / 2);
+      std::fill_n(palette[3], 4, 0);
+
+    } else {
+      for (uint32_t c = 0; c < 3; c++) {
+        palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+        palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+      }
+    }
+
+    const uint32_t candidates = has_transparent ? 3 : 4;
+    uint32_t       indices    = 0;
+
+    for (uint32_t i = 0; i < 16 && color0 != color1; i++) {
+      uint32_t best = 0;
+
+      if (has_transparent && texels[i][3] < 128) {
+        best = 3;
+
+      } else {
+        for (uint32_t candidate = 1; candidate < candidates; candidate++) {
+          if (Distance(texels[i], palette[candidate], 3) < Distance(texels[i], palette[best], 3)) best = candidate;
+        }
+      }
+
+      indices |= best << (i * 2);
+    }
+
+    if (color0 == color1 && has_transparent) {
+      for (uint32_t i = 0; i < 16; i++) indices |= (texels[i][3] < 128 ? 3u : 0u) << (i * 2);
+    }
+
+    std::memcpy(block + 0, &color0, 2);
+    std::memcpy(block + 2, &color1, 2);
+    std::memcpy(block + 4, &indices, 4);
+  }
+
+  static void EncodeAlphaBlock(const uint8_t (&texels)[16][4], uint8_t* block) {
+    uint8_t alpha0 = 0, alpha1 = 255;
+
+    for (uint32_t i = 0; i < 16; i++) {
+      alpha0 = std::max(alpha0, texels[i][3]);
+      alpha1 = std::min(alpha1, texels[i][3]);
+    }
+
+    uint8_t palette[8] = {alpha0, alpha1};
+    for (uint32_t i = 1; i < 7; i++) palette[i + 1] = (uint8_t)(((7 - i) * alpha0 + i * alpha1) / 7);
+
+    uint64_t indices = 0;
+
+    for (uint32_t i = 0; i < 16 && alpha0 != alpha1; i++) {
+      uint64_t best = 0;
+
+      for (uint32_t candidate = 1; candidate < 8; candidate++) {
+        if (std::abs(texels[i][3] - palette[candidate]) < std::abs(texels[i][3] - palette[best])) best = candidate;
+      }
+
+      indices |= best << (i * 3);
+    }
+
+    block[0] = alpha0;
+    block[1] = alpha1;
+    for (uint32_t i = 0; i < 6; i++) block[2 + i] = (uint8_t)(indices >> (i * 8));
+  }
+
+  void EncodeBC1Block(const uint8_t (&texels)[16][4], uint8_t* block) { EncodeColorBlock(texels, block, true); }
+
+  void EncodeBC3Block(const uint8_t (&texels)[16][4], uint8_t* block) {
+    EncodeAlphaBlock(texels, block);
+    EncodeColorBlock(texels, block + 8, false);
+  }
+
+  void EncodeBC7Block(const uint8_t (&texels)[16][4], uint8_t* block) {
+    uint8_t low[4], high[4];
+    FindEndpoints(texels, 4, false, low, high);
+
+    // Mode 6 endpoints are 7 bits per channel plus a shared per-endpoint p-bit
+    uint8_t quantized[2][4], pbits[2], endpoints[2][4];
+
+    for (uint32_t e = 0; e < 2; e++) {
+      const uint8_t* source     = e == 0 ? low : high;
+      uint32_t       best_error = UINT32_MAX;
+
+      for (uint8_t p = 0; p < 2; p++) {
+        uint8_t  candidate[4], expanded[4];
+        uint32_t error = 0;
+
+        for (uint32_t c = 0; c < 4; c++) {
+          candidate[c] = (uint8_t)std::clamp((source[c] - p + 1) / 2, 0, 127);
+          expanded[c]  = (uint8_t)((candidate[c] << 1) | p);
+        }
+
+        error = Distance(source, expanded, 4);
+
+        if (error < best_error) {
+          best_error = error;
+          pbits[e]   = p;
+          std::copy_n(candidate, 4, quantized[e]);
+          std::copy_n(expanded, 4, endpoints[e]);
+        }
+      }
+    }
+
+    uint8_t palette[16][4];
+    for (uint32_t i = 0; i < 16; i++) {
+      for (uint32_t c = 0; c < 4; c++) {
+        palette[i][c] =
+            (uint8_t)(((64 - bc7_weights[i]) * endpoints[0][c] + bc7_weights[i] * endpoints[1][c] + 32) >> 6);
+      }
+    }
+
+    uint8_t indices[16];
+    for (uint32_t i = 0; i < 16; i++) {
+      indices[i] = 0;
+
+      for (uint8_t candidate = 1; candidate < 16; candidate++) {
+        if (Distance(texels[i], palette[candidate], 4) < Distance(texels[i], palette[indices[i]], 4)) {
+          indices[i] = candidate;
+        }
+      }
+    }
+
+    // The anchor texel stores its index with an implicit zero top bit
+    if (indices[0] & 8) {
+      std::swap(quantized[0], quantized[1]);
+      std::swap(pbits[0], pbits[1]);
+      for (auto& index : indices) index = 15 - index;
+    }
+
+    std::fill_n(block, 16, 0);
+    BitWriter writer {block};
+
+    writer.Write(1 << 6, 7);
+
+    for (uint32_t c = 0; c < 4; c++) {
+      writer.Write(quantized[0][c], 7);
+      writer.Write(quantized[1][c], 7);
+    }
+
+    writer.Write(pbits[0], 1);
+    writer.Write(pbits[1], 1);
+
+    writer.Write(indices[0], 3);
+    for (uint32_t i = 1; i < 16; i++) writer.Write(indices[i], 4);
+  }
+
+  std::vector<uint8_t> CompressTexture(const TextureImage& image, TextureFormat format) {
+    if (format == TextureFormat::rgba8) return image.pixels;
+
+    const uint32_t block_size = format == TextureFormat::bc1 ? 8 : 16;
+    const uint32_t blocks_x   = (image.size.x + 3) / 4;
+    const uint32_t blocks_y   = (image.size.y + 3) / 4;
+
+    std::vector<uint8_t> result(blocks_x * blocks_y * block_size);
+
+    // Blocks are independent, so rows of them are spread over the job system in ranges of about 1024 blocks
+    const uint32_t grain = std::max(1024 / blocks_x, 1u);
+
+    JobSystem::Default().ParallelFor(blocks_y, grain, [&](uint32_t begin, uint32_t end) {
+      uint8_t texels[16][4];
+
+      for (uint32_t by = begin; by < end; by++) {
+        for (uint32_t bx = 0; bx < blocks_x; bx++) {
+          for (uint32_t i = 0; i < 16; i++) {
+            const uint32_t x = std::min(bx * 4 + i % 4, image.size.x - 1);
+            const uint32_t y = std::min(by * 4 + i / 4, image.size.y - 1);
+
+            std::copy_n(&image.pixels[(y * image.size.x + x) * 4], 4, texels[i]);
+          }
+
+          uint8_t* block = &result[(by * blocks_x + bx) * block_size];
+
+          switch (format) {
+            case TextureFormat::bc1:
+              EncodeBC1Block(texels, block);
+              break;
+
+            case TextureFormat::bc3:
+              EncodeBC3Block(texels, block);
+              break;
+
+            default:
+              EncodeBC7Block(texels, block);
+              break;
+          }
+        }
+      }
+    });
+
+    return result;
+  }
+}
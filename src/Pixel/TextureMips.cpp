@@ -0,0 +1,193 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Pixel/TextureMips.hpp"
+
+namespace Pixel {
+  static constexpr int32_t kaiser_radius = 4;  // In source texels, on each side of the destination texel center
+  static constexpr float   kaiser_alpha  = 4.f;
+
+  static float BesselI0(float x) {
+    float sum  = 1.f;
+    float term = 1.f;
+
+    for (uint32_t k = 1; k < 16; k++) {
+      term *= (x / (2.f * k)) * (x / (2.f * k));
+      sum += term;
+    }
+
+    return sum;
+  }
+
+  static std::array<float, kaiser_radius * 2> KaiserWeights() {
+    std::array<float, kaiser_radius * 2> weights;
+    float                                total = 0.f;
+
+    for (int32_t tap = 0; tap < kaiser_radius * 2; tap++) {
+      const float x      = ((tap - kaiser_radius) + .5f) / 2.f;  // Distance in destination texels
+      const float ratio  = x / (kaiser_radius / 2.f);
+      const float sinc   = glm::sin(glm::pi<float>() * x) / (glm::pi<float>() * x);
+      const float window = BesselI0(kaiser_alpha * std::sqrt(1.f - ratio * ratio)) / BesselI0(kaiser_alpha);
+
+      weights[tap] = sinc * window;
+      total += weights[tap];
+    }
+
+    for (auto& weight : weights) weight /= total;
+    return weights;
+  }
+
+  // Decimates by two along one axis, reading `count` RGBA texels `stride` floats apart
+  static void KaiserPass(const float* source,
+                         float*       destination,
+                         uint32_t     source_count,
+                         uint32_t     destination_count,
+                         uint32_t     source_stride,
+                         uint32_t     destination_stride) {
+    static const auto weights = KaiserWeights();
+
+    for (uint32_t i = 0; i < destination_count; i++) {
+      float result[4] = {};
+
+      for (int32_t tap = 0; tap < kaiser_radius * 2; tap++) {
+        const int32_t index = std::clamp((int32_t)(i * 2) + tap - kaiser_radius + 1, 0, (int32_t)source_count - 1);
+        const float*  texel = source + index * source_stride;
+
+        for (uint32_t c = 0; c < 4; c++) result[c] += texel[c] * weights[tap];
+      }
+
+      for (uint32_t c = 0; c < 4; c++) destination[i * destination_stride + c] = result[c];
+    }
+  }
+
+  uint32_t MipLevelCount(const glm::uvec2& size) {
+    uint32_t levels = 1;
+    for (uint32_t largest = std::max(size.x, size.y); largest > 1; largest /= 2) levels++;
+
+    return levels;
+  }
+
+  struct BoxTaps {
+    uint32_t index[3]  = {};
+    float    weight[3] = {};
+  };
+
+  // Source texels and weights for one destination texel along an axis. Even sizes average pairs, odd sizes spread
+  // each destination texel over three source texels so the trailing one is weighted in rather than dropped.
+  static BoxTaps BoxFootprint(uint32_t source_count, uint32_t i) {
+    BoxTaps taps;
+
+    if (source_count == 1) {
+      taps.weight[0] = 1.f;
+
+    } else if (source_count % 2 == 0) {
+      taps.index[0]  = i * 2;
+      taps.index[1]  = i * 2 + 1;
+      taps.weight[0] = taps.weight[1] = .5f;
+
+    } else {
+      const uint32_t half = source_count / 2;
+
+      for (uint32_t tap = 0; tap < 3; tap++) taps.index[tap] = i * 2 + tap;
+      taps.weight[0] = (float)(half - i) / source_count;
+      taps.weight[1] = (float)half / source_count;
+      taps.weight[2] = (float)(i + 1) / source_count;
+    }
+
+    return taps;
+  }
+
+  TextureImage DownsampleBox(const TextureImage& image) {
+    TextureImage result;
+    result.size = {std::max(image.size.x / 2, 1u), std::max(image.size.y / 2, 1u)};
+    result.pixels.resize(result.size.x * result.size.y * 4);
+
+    for (uint32_t y = 0; y < result.size.y; y++) {
+      const BoxTaps rows = BoxFootprint(image.size.y, y);
+
+      for (uint32_t x = 0; x < result.size.x; x++) {
+        const BoxTaps columns = BoxFootprint(image.size.x, x);
+        float         sum[4]  = {};
+
+        for (uint32_t j = 0; j < 3; j++) {
+          for (uint32_t i = 0; i < 3; i++) {
+            const float weight = rows.weight[j] * columns.weight[i];
+            if (weight == 0.f) continue;
+
+            const uint8_t* texel = &image.pixels[(rows.index[j] * image.size.x + columns.index[i]) * 4];
+            for (uint32_t c = 0; c < 4; c++) sum[c] += texel[c] * weight;
+          }
+        }
+
+        for (uint32_t c = 0; c < 4; c++) {
+          result.pixels[(y * result.size.x + x) * 4 + c] = (uint8_t)std::clamp(sum[c] + .5f, 0.f, 255.f);
+        }
+      }
+    }
+
+    return result;
+  }
+
+  TextureImage DownsampleKaiser(const TextureImage& image) {
+    TextureImage result;
+    result.size = {std::max(image.size.x / 2, 1u), std::max(image.size.y / 2, 1u)};
+    result.pixels.resize(result.size.x * result.size.y * 4);
+
+    std::vector<float> source(image.pixels.begin(), image.pixels.end());
+    std::vector<float> horizontal(result.size.x * image.size.y * 4);
+    std::vector<float> vertical(result.size.x * result.size.y * 4);
+
+    for (uint32_t y = 0; y < image.size.y; y++) {
+      if (image.size.x == 1) {
+        std::copy_n(&source[y * 4], 4, &horizontal[y * 4]);
+
+      } else {
+        KaiserPass(
+            &source[y * image.size.x * 4], &horizontal[y * result.size.x * 4], image.size.x, result.size.x, 4, 4);
+      }
+    }
+
+    for (uint32_t x = 0; x < result.size.x; x++) {
+      if (image.size.y == 1) {
+        std::copy_n(&horizontal[x * 4], 4, &vertical[x * 4]);
+
+      } else {
+        KaiserPass(
+            &horizontal[x * 4], &vertical[x * 4], image.size.y, result.size.y, result.size.x * 4, result.size.x * 4);
+      }
+    }
+
+    for (size_t i = 0; i < vertical.size(); i++) {
+      result.pixels[i] = (uint8_t)std::clamp(vertical[i] + .5f, 0.f, 255.f);
+    }
+
+    return result;
+  }
+
+  std::vector<TextureImage> GenerateMipChain(const TextureImage& base, MipFilter filter) {
+    std::vector<TextureImage> chain;
+    chain.reserve(MipLevelCount(base.size));
+    chain.push_back(base);
+
+    while (chain.back().size.x > 1 || chain.back().size.y > 1) {
+      chain.push_back(filter == MipFilter::kaiser ? DownsampleKaiser(chain.back()) : DownsampleBox(chain.back()));
+    }
+
+    return chain;
+  }
+}
@@ -0,0 +1,136 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Util/Metrics.hpp"
+
+namespace Pixel {
+  uint32_t Histogram::BucketOf(uint64_t value) {
+    if (value < 2 * pSubBuckets) return (uint32_t)value;
+
+    // Keep the top five significant bits, the shift picks the power of two and the bits below the leading one the
+    // linear bucket inside it
+    const uint32_t shift = (uint32_t)std::bit_width(value) - 5;
+    return shift * pSubBuckets + (uint32_t)(value >> shift);
+  }
+
+  uint64_t Histogram::BucketUpperBound(uint32_t bucket) {
+    if (bucket < 2 * pSubBuckets) return bucket;
+
+    const uint32_t shift = bucket / pSubBuckets - 1;
+    const uint64_t top   = bucket % pSubBuckets + pSubBuckets;
+
+    return ((top + 1) << shift) - 1;
+  }
+
+  void Histogram::Record(uint64_t value) {
+    pCounts[std::min(BucketOf(value), pBuckets - 1)]++;
+    pCount++;
+    pMax = std::max(pMax, value);
+  }
+
+  void Histogram::Reset() {
+    pCounts.fill(0);
+    pCount = 0;
+    pMax   = 0;
+  }
+
+  uint64_t Histogram::Percentile(float percentile) const {
+    if (pCount == 0) return 0;
+
+    const uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(percentile / 100.f * pCount));
+    uint64_t       seen = 0;
+
+    for (uint32_t bucket = 0; bucket < pBuckets; bucket++) {
+      seen += pCounts[bucket];
+      if (seen >= rank) return std::min(BucketUpperBound(bucket), pMax);
+    }
+
+    return pMax;
+  }
+
+  Metric::Metric(std::string_view name, MetricUnit unit)
+      : pName(name), pUnit(unit), pHistogramScale(unit == MetricUnit::seconds ? 1e6f : 1.f) {}  // Microseconds
+
+  void Metric::Record(float value) {
+    pSamples[pHead] = value;
+    pHead           = (pHead + 1) % pCapacity;
+    pCount          = std::min(pCount + 1, pCapacity);
+
+    pHistogram.Record((uint64_t)std::max(value * pHistogramScale, 0.f));
+  }
+
+  void Metric::Reset() {
+    pHead  = 0;
+    pCount = 0;
+    pHistogram.Reset();
+  }
+
+  float Metric::Sample(uint32_t age) const { return pSamples[(pHead + pCapacity - 1 - age) % pCapacity]; }
+
+  float Metric::Last() const { return pCount > 0 ? Sample(0) : 0.f; }
+
+  float Metric::Mean(uint32_t samples) const {
+    samples = std::min(samples, pCount);
+    if (samples == 0) return 0.f;
+
+    float sum = 0.f;
+    for (uint32_t i = 0; i < samples; i++) sum += Sample(i);
+
+    return sum / samples;
+  }
+
+  MetricSummary Metric::Summary() const {
+    MetricSummary summary;
+    if (pCount == 0) return summary;
+
+    for (uint32_t i = 0; i < pCount; i++) pScratch[i] = Sample(i);
+    std::sort(pScratch.begin(), pScratch.begin() + pCount);
+
+    const auto percentile = [&](float p) { return pScratch[std::min((uint32_t)(p / 100.f * pCount), pCount - 1)]; };
+
+    summary.last = Last();
+    summary.mean = Mean();
+    summary.p50  = percentile(50.f);
+    summary.p95  = percentile(95.f);
+    summary.p99  = percentile(99.f);
+    summary.max  = pScratch[pCount - 1];
+
+    return summary;
+  }
+
+  float Metric::HistoryPercentile(float percentile) const {
+    return pHistogram.Percentile(percentile) / pHistogramScale;
+  }
+
+  uint32_t MetricsRegistry::Register(std::string_view name, MetricUnit unit) {
+    pMetrics.push_back(std::make_unique<Metric>(name, unit));
+    return (uint32_t)pMetrics.size() - 1;
+  }
+
+  void MetricsRegistry::Reset() {
+    for (auto& metric : pMetrics) metric->Reset();
+  }
+
+  const Metric* MetricsRegistry::Find(std::string_view name) const {
+    for (const auto& metric : pMetrics) {
+      if (metric->Name() == name) return metric.get();
+    }
+
+    return nullptr;
+  }
+}
@@ -0,0 +1,282 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Util/PngWriter.hpp"
+
+namespace Pixel {
+  static constexpr uint16_t length_base[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                               31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+  static constexpr uint8_t  length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+  static constexpr uint16_t distance_base[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                                 33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                                 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+  static constexpr uint8_t  distance_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                                  6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+  static const std::array<uint32_t, 256> crc_table = [] {
+    std::array<uint32_t, 256> table {};
+
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (uint32_t bit = 0; bit < 8; bit++) crc = (crc & 1) ? 0xedb88320u ^ (crc >> 1) : crc >> 1;
+      table[i] = crc;
+    }
+
+    return table;
+  }();
+
+  static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+  }
+
+  static uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size) {
+    uint32_t a = adler & 0xffff, b = adler >> 16;
+
+    // 5552 is the largest run that cannot overflow before the modulo
+    while (size > 0) {
+      const size_t run = std::min<size_t>(size, 5552);
+
+      for (size_t i = 0; i < run; i++) {
+        a += data[i];
+        b += a;
+      }
+
+      a %= 65521;
+      b %= 65521;
+      data += run;
+      size -= run;
+    }
+
+    return (b << 16) | a;
+  }
+
+  static void StoreBigEndian(uint8_t* out, uint32_t value) {
+    out[0] = value >> 24;
+    out[1] = value >> 16;
+    out[2] = value >> 8;
+    out[3] = value;
+  }
+
+  bool PngWriter::Open(const std::filesystem::path& filepath, const glm::uvec2& size, uint32_t channels) {
+    pFile.open(filepath, std::ios::binary | std::ios::trunc);
+    if (!pFile.good()) return false;
+
+    pSize        = size;
+    pChannels    = channels;
+    pRowsWritten = 0;
+    pAdler       = 1;
+
+    pFiltered.resize(1 + (size_t)size.x * channels);
+    pHistory.clear();
+    pHistoryBase = 0;
+    pHashHeads.assign(1 << pHashBits, -1);
+
+    pOutput.clear();
+    pBitBuffer = 0;
+    pBitCount  = 0;
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    pFile.write((const char*)signature, sizeof(signature));
+
+    uint8_t header[13];
+    StoreBigEndian(header, size.x);
+    StoreBigEndian(header + 4, size.y);
+    header[8]  = 8;                         // Bit depth
+    header[9]  = channels == 4 ? 6 : 2;     // RGBA or RGB
+    header[10] = header[11] = header[12] = 0;  // Deflate, adaptive filtering, no interlace
+    pWriteChunk("IHDR", header, sizeof(header));
+
+    // zlib header for a 32K window with the fastest compression level hint
+    pOutput.push_back(0x78);
+    pOutput.push_back(0x01);
+
+    return true;
+  }
+
+  void PngWriter::WriteRow(const uint8_t* row) {
+    const uint32_t stride = pSize.x * pChannels;
+
+    pFiltered[0] = 1;  // Sub
+    for (uint32_t i = 0; i < pChannels; i++) pFiltered[1 + i] = row[i];
+    for (uint32_t i = pChannels; i < stride; i++) pFiltered[1 + i] = row[i] - row[i - pChannels];
+
+    pAdler = Adler32(pAdler, pFiltered.data(), pFiltered.size());
+    pDeflate(pFiltered.data(), (uint32_t)pFiltered.size(), false);
+
+    pRowsWritten++;
+    pFlushChunk(false);
+  }
+
+  bool PngWriter::Close() {
+    if (!pFile.is_open()) return false;
+
+    pDeflate(nullptr, 0, true);
+    if (pBitCount > 0) pWriteBits(0, 8 - pBitCount);
+
+    uint8_t adler[4];
+    StoreBigEndian(adler, pAdler);
+    pOutput.insert(pOutput.end(), adler, adler + 4);
+
+    pFlushChunk(true);
+    pWriteChunk("IEND", nullptr, 0);
+
+    const bool complete = pRowsWritten == pSize.y && pFile.good();
+    pFile.close();
+
+    pHistory   = {};
+    pHashHeads = {};
+    pOutput    = {};
+
+    return complete;
+  }
+
+  void PngWriter::pDeflate(const uint8_t* data, uint32_t size, bool final) {
+    // Every call is its own fixed Huffman block, matches may still reach back into earlier blocks
+    pWriteBits(final ? 1 : 0, 1);
+    pWriteBits(1, 2);
+
+    const uint64_t start = pHistory.size();
+    pHistory.insert(pHistory.end(), data, data + size);
+
+    const uint64_t end = pHistory.size();
+    uint64_t       i   = start;
+
+    const auto hash = [&](uint64_t index) {
+      const uint32_t value = pHistory[index] | (pHistory[index + 1] << 8) | (pHistory[index + 2] << 16);
+      return (value * 2654435761u) >> (32 - pHashBits);
+    };
+
+    while (i < end) {
+      uint32_t match_length   = 0;
+      uint32_t match_distance = 0;
+
+      if (i + 3 <= end) {
+        const uint32_t h         = hash(i);
+        const int64_t  candidate = pHashHeads[h];
+        const int64_t  position  = (int64_t)(pHistoryBase + i);
+        pHashHeads[h]            = position;
+
+        if (candidate >= (int64_t)pHistoryBase && position - candidate <= pWindowSize) {
+          const uint64_t from  = candidate - pHistoryBase;
+          const uint32_t limit = (uint32_t)std::min<uint64_t>(258, end - i);
+
+          while (match_length < limit && pHistory[from + match_length] == pHistory[i + match_length]) match_length++;
+          match_distance = (uint32_t)(position - candidate);
+        }
+      }
+
+      if (match_length >= 3) {
+        pWriteMatch(match_length, match_distance);
+
+        for (uint64_t j = i + 1; j < i + match_length && j + 3 <= end; j++) {
+          pHashHeads[hash(j)] = (int64_t)(pHistoryBase + j);
+        }
+
+        i += match_length;
+
+      } else {
+        pWriteLiteral(pHistory[i]);
+        i++;
+      }
+    }
+
+    pWriteLiteral(256);  // End of block
+
+    if (pHistory.size() > pWindowSize) {
+      const uint64_t drop = pHistory.size() - pWindowSize;
+
+      pHistory.erase(pHistory.begin(), pHistory.begin() + drop);
+      pHistoryBase += drop;
+    }
+  }
+
+  void PngWriter::pWriteBits(uint32_t bits, uint32_t count) {
+    pBitBuffer |= (uint64_t)bits << pBitCount;
+    pBitCount += count;
+
+    while (pBitCount >= 8) {
+      pOutput.push_back((uint8_t)pBitBuffer);
+      pBitBuffer >>= 8;
+      pBitCount -= 8;
+    }
+  }
+
+  void PngWriter::pWriteCode(uint32_t code, uint32_t length) {
+    // Huffman codes are defined most significant bit first while the stream is packed least significant bit first
+    uint32_t reversed = 0;
+    for (uint32_t i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+
+    pWriteBits(reversed, length);
+  }
+
+  void PngWriter::pWriteLiteral(uint32_t symbol) {
+    if (symbol < 144) {
+      pWriteCode(0x30 + symbol, 8);
+
+    } else if (symbol < 256) {
+      pWriteCode(0x190 + symbol - 144, 9);
+
+    } else if (symbol < 280) {
+      pWriteCode(symbol - 256, 7);
+
+    } else {
+      pWriteCode(0xc0 + symbol - 280, 8);
+    }
+  }
+
+  void PngWriter::pWriteMatch(uint32_t length, uint32_t distance) {
+    uint32_t length_code = 28;
+    while (length_base[length_code] > length) length_code--;
+
+    pWriteLiteral(257 + length_code);
+    pWriteBits(length - length_base[length_code], length_extra[length_code]);
+
+    uint32_t distance_code = 29;
+    while (distance_base[distance_code] > distance) distance_code--;
+
+    pWriteCode(distance_code, 5);
+    pWriteBits(distance - distance_base[distance_code], distance_extra[distance_code]);
+  }
+
+  void PngWriter::pFlushChunk(bool force) {
+    if (pOutput.empty() || (!force && pOutput.size() < pChunkSize)) return;
+
+    pWriteChunk("IDAT", pOutput.data(), (uint32_t)pOutput.size());
+    pOutput.clear();
+  }
+
+  void PngWriter::pWriteChunk(const char* type, const uint8_t* data, uint32_t size) {
+    uint8_t header[8];
+    StoreBigEndian(header, size);
+    std::memcpy(header + 4, type, 4);
+
+    uint32_t crc = Crc32(0, header + 4, 4);
+    if (size > 0) crc = Crc32(crc, data, size);
+
+    uint8_t footer[4];
+    StoreBigEndian(footer, crc);
+
+    pFile.write((const char*)header, sizeof(header));
+    if (size > 0) pFile.write((const char*)data, size);
+    pFile.write((const char*)footer, sizeof(footer));
+  }
+}
@@ -0,0 +1,197 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Util/Profiler.hpp"
+
+namespace Pixel {
+  struct ProfileEvent {
+    const char* name  = nullptr;
+    uint64_t    begin = 0;
+    uint64_t    end   = 0;
+  };
+
+  struct ThreadRing {
+    std::unique_ptr<ProfileEvent[]> events = std::make_unique<ProfileEvent[]>(Profiler::pRingSize);
+    std::atomic<uint64_t>           head {0};
+    std::atomic<const char*>        name {nullptr};
+    uint32_t                        id = 0;
+
+    // Only touched by the owning thread
+    uint64_t previous_frame_mark = 0;
+    uint64_t last_frame_mark     = 0;
+  };
+
+  // Rings are never freed, events of threads that already exited can still be exported
+  static std::mutex                               rings_mutex;
+  static std::vector<std::unique_ptr<ThreadRing>> rings;
+
+  static ThreadRing& LocalRing() {
+    thread_local ThreadRing* ring = [] {
+      std::lock_guard<std::mutex> lock(rings_mutex);
+
+      rings.push_back(std::make_unique<ThreadRing>());
+      rings.back()->id = (uint32_t)rings.size();
+
+      return rings.back().get();
+    }();
+
+    return *ring;
+  }
+
+  std::atomic<bool>     Profiler::pCapturing {false};
+  std::atomic<bool>     Profiler::pLive {false};
+  std::atomic<uint32_t> Profiler::pFramesLeft {0};
+  std::atomic<uint64_t> Profiler::pCaptureBegin {0};
+  std::atomic<uint64_t> Profiler::pCaptureEnd {0};
+
+  uint64_t Profiler::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void Profiler::BeginCapture(uint32_t frames) {
+    pFramesLeft   = frames;
+    pCaptureBegin = Now();
+    pCaptureEnd   = UINT64_MAX;
+    pCapturing    = true;
+  }
+
+  void Profiler::EndCapture() {
+    if (!pCapturing) return;
+
+    pCaptureEnd = Now();
+    pCapturing  = false;
+  }
+
+  void Profiler::FrameMark() {
+    if (!Recording()) return;
+
+    ThreadRing& ring         = LocalRing();
+    ring.previous_frame_mark = ring.last_frame_mark;
+    ring.last_frame_mark     = Now();
+
+    if (!pCapturing) return;
+
+    uint32_t left = pFramesLeft;
+    if (left == 0) return;
+
+    if (pFramesLeft.compare_exchange_strong(left, left - 1) && left == 1) EndCapture();
+  }
+
+  void Profiler::SetThreadName(const char* name) { LocalRing().name = name; }
+
+  void Profiler::Record(const char* name, uint64_t begin, uint64_t end) {
+    ThreadRing&    ring = LocalRing();
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+    ring.events[head % pRingSize] = {name, begin, end};
+    ring.head.store(head + 1, std::memory_order_release);
+  }
+
+  uint32_t Profiler::LastFrameZones(ProfileZoneTotal* zones, uint32_t max_zones) {
+    const ThreadRing& ring = LocalRing();
+    if (ring.previous_frame_mark == 0) return 0;
+
+    static constexpr uint32_t max_names = 64;
+
+    ProfileZoneTotal totals[max_names];
+    uint32_t         count = 0;
+
+    // Events are appended when their zone ends, so walking back from the newest, end times only decrease
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+    for (uint64_t i = head; i > 0 && head - i < pRingSize; i--) {
+      const ProfileEvent& event = ring.events[(i - 1) % pRingSize];
+
+      if (event.end < ring.previous_frame_mark) break;
+      if (event.end > ring.last_frame_mark) continue;
+
+      uint32_t slot = 0;
+      while (slot < count && totals[slot].name != event.name) slot++;
+
+      if (slot == count) {
+        if (count == max_names) continue;
+        totals[count++] = {event.name, 0, 0};
+      }
+
+      totals[slot].time += event.end - event.begin;
+      totals[slot].calls++;
+    }
+
+    const uint32_t returned = std::min(count, max_zones);
+
+    std::partial_sort(totals, totals + returned, totals + count, [](const auto& a, const auto& b) {
+      return a.time > b.time;
+    });
+    std::copy_n(totals, returned, zones);
+
+    return returned;
+  }
+
+  static void WriteJsonString(std::ofstream& file, const char* text) {
+    file << '"';
+
+    for (; *text; text++) {
+      if (*text == '"' || *text == '\\') file << '\\';
+      file << *text;
+    }
+
+    file << '"';
+  }
+
+  bool Profiler::WriteChromeTrace(const std::filesystem::path& filepath) {
+    std::ofstream file(filepath, std::ios::trunc);
+    if (!file.good()) return false;
+
+    const uint64_t capture_begin = pCaptureBegin;
+    const uint64_t capture_end   = pCaptureEnd;
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(rings_mutex);
+
+    for (const auto& ring : rings) {
+      if (const char* name = ring->name) {
+        file << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->id
+             << ",\"args\":{\"name\":";
+        WriteJsonString(file, name);
+        file << "}}";
+        first = false;
+      }
+
+      // Older events than one ring's worth have been overwritten
+      const uint64_t head  = ring->head.load(std::memory_order_acquire);
+      const uint64_t start = head > pRingSize ? head - pRingSize : 0;
+
+      for (uint64_t i = start; i < head; i++) {
+        const ProfileEvent event = ring->events[i % pRingSize];
+        if (event.begin < capture_begin || event.begin > capture_end) continue;
+
+        file << (first ? "\n" : ",\n") << "{\"name\":";
+        WriteJsonString(file, event.name);
+        file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->id << ",\"ts\":" << (event.begin - capture_begin) / 1000.
+             << ",\"dur\":" << (event.end - event.begin) / 1000. << "}";
+        first = false;
+      }
+    }
+
+    file << "\n]}\n";
+    return file.good();
+  }
+}
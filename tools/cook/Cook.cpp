@@ -0,0 +1,209 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.hpp"
+#include "Pixel/AssetPack.hpp"
+#include "Pixel/TextureCompression.hpp"
+#include "Pixel/TextureMips.hpp"
+#include "Util/Logger.hpp"
+
+using namespace Pixel;
+
+struct CookedEntry {
+  PackEntry                         entry;
+  std::vector<std::vector<uint8_t>> blobs;
+};
+
+static std::vector<uint8_t> ReadFile(const std::string& filepath) {
+  std::ifstream file(filepath, std::ios::binary);
+  if (!file.good()) Logger::Die("Cannot read " + filepath);
+
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void SetName(PackEntry& entry, const std::string& name) {
+  if (name.size() >= sizeof(entry.name)) Logger::Die("Asset name " + name + " is too long");
+  std::memcpy(entry.name, name.data(), name.size());
+}
+
+static CookedEntry CookTexture(const std::string& name, const std::string& filepath, const TextureOptions& options) {
+  int32_t width, height, channels;
+
+  stbi_set_flip_vertically_on_load(1);
+  stbi_uc* data = stbi_load(filepath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+  if (!data) Logger::Die("Cannot decode " + filepath + ": " + stbi_failure_reason());
+
+  TextureImage base;
+  base.size = {(uint32_t)width, (uint32_t)height};
+  base.pixels.assign(data, data + width * height * 4);
+  stbi_image_free(data);
+
+  CookedEntry cooked;
+  SetName(cooked.entry, name);
+  cooked.entry.type   = PackEntryType::texture;
+  cooked.entry.format = options.format;
+  cooked.entry.width  = base.size.x;
+  cooked.entry.height = base.size.y;
+
+  if (options.mips == MipFilter::none) {
+    cooked.blobs.push_back(CompressTexture(base, options.format));
+
+  } else {
+    for (const auto& level : GenerateMipChain(base, options.mips)) {
+      cooked.blobs.push_back(CompressTexture(level, options.format));
+    }
+  }
+
+  return cooked;
+}
+
+static CookedEntry CookShader(const std::string& name,
+                              const std::string& vertex_path,
+                              const std::string& fragment_path) {
+  CookedEntry cooked;
+  SetName(cooked.entry, name);
+  cooked.entry.type = PackEntryType::shader;
+
+  cooked.blobs.push_back(ReadFile(vertex_path));
+  cooked.blobs.push_back(ReadFile(fragment_path));
+
+  return cooked;
+}
+
+static void Align(std::ofstream& file) {
+  static const char padding[pack_alignment] = {};
+
+  const uint64_t position = (uint64_t)file.tellp();
+  const uint64_t aligned  = (position + pack_alignment - 1) & ~(uint64_t)(pack_alignment - 1);
+
+  file.write(padding, aligned - position);
+}
+
+static void WritePack(const std::string& filepath, std::vector<CookedEntry>& entries) {
+  std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+  if (!file.good()) Logger::Die("Cannot write " + filepath);
+
+  PackHeader header;
+  header.entry_count = (uint32_t)entries.size();
+  file.write((const char*)&header, sizeof(header));
+
+  for (auto& cooked : entries) {
+    std::vector<PackBlob> blobs;
+
+    for (auto& blob : cooked.blobs) {
+      Align(file);
+      blobs.push_back({(uint64_t)file.tellp(), blob.size()});
+      file.write((const char*)blob.data(), blob.size());
+    }
+
+    Align(file);
+    cooked.entry.blob_count  = (uint32_t)blobs.size();
+    cooked.entry.blob_offset = (uint64_t)file.tellp();
+    file.write((const char*)blobs.data(), blobs.size() * sizeof(PackBlob));
+  }
+
+  Align(file);
+  header.entry_offset = (uint64_t)file.tellp();
+
+  for (auto& cooked : entries) {
+    file.write((const char*)&cooked.entry, sizeof(PackEntry));
+  }
+
+  file.seekp(0);
+  file.write((const char*)&header, sizeof(header));
+
+  if (!file.good()) Logger::Die("Failed writing " + filepath);
+}
+
+[[noreturn]] static void Usage() {
+  std::cout << "Usage: pixel_cook -o <output> [--mips none|box|kaiser] [--format rgba8|bc1|bc3|bc7]\n"
+               "                  [-t <name>=<image>]... [-s <name>=<vertex>,<fragment>]...\n"
+               "Texture options apply to every -t that follows them.\n";
+  exit(1);
+}
+
+static MipFilter ParseMipFilter(const std::string& value) {
+  if (value == "none") return MipFilter::none;
+  if (value == "box") return MipFilter::box;
+  if (value == "kaiser") return MipFilter::kaiser;
+
+  Usage();
+}
+
+static TextureFormat ParseFormat(const std::string& value) {
+  if (value == "rgba8") return TextureFormat::rgba8;
+  if (value == "bc1") return TextureFormat::bc1;
+  if (value == "bc3") return TextureFormat::bc3;
+  if (value == "bc7") return TextureFormat::bc7;
+
+  Usage();
+}
+
+int main(int argc, char** argv) {
+  std::string              output;
+  TextureOptions           options;
+  std::vector<CookedEntry> entries;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+
+    if (i + 1 >= argc) Usage();
+    const std::string value = argv[++i];
+
+    if (arg == "-o") {
+      output = value;
+      continue;
+    }
+
+    if (arg == "--mips") {
+      options.mips = ParseMipFilter(value);
+      continue;
+    }
+
+    if (arg == "--format") {
+      options.format = ParseFormat(value);
+      continue;
+    }
+
+    const size_t equals = value.find('=');
+    if (equals == std::string::npos) Usage();
+
+    const std::string name = value.substr(0, equals);
+    const std::string path = value.substr(equals + 1);
+
+    if (arg == "-t") {
+      entries.push_back(CookTexture(name, path, options));
+
+    } else if (arg == "-s") {
+      const size_t comma = path.find(',');
+      if (comma == std::string::npos) Usage();
+
+      entries.push_back(CookShader(name, path.substr(0, comma), path.substr(comma + 1)));
+
+    } else {
+      Usage();
+    }
+  }
+
+  if (output.empty()) Usage();
+
+  WritePack(output, entries);
+  Logger::Info("Cooked " + std::to_string(entries.size()) + " assets into " + output);
+
+  return 0;
+}
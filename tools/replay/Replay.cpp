@@ -0,0 +1,241 @@
+/*
+Pixel, a simple 2D, multiplatform application engine for OpenGL graphics written in C++
+Copyright (C) 2022 DarthChungo
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.hpp"
+#include "Pixel/Application.hpp"
+#include "Pixel/CommandRecording.hpp"
+#include "Pixel/NullBackend.hpp"
+#include "Pixel/Renderer.hpp"
+#include "Pixel/SoftwareBackend.hpp"
+#include "Util/Logger.hpp"
+
+using namespace Pixel;
+
+// Plays back a recording made with Application::StartRecording as fast as the context allows, with vsync off, and
+// reports frame time percentiles and draw calls per frame as JSON. The null and software contexts need no GPU; the
+// null one also reports a checksum of everything submitted, which matches between replays of the same recording.
+//
+//   pixel_replay recording.pxrc [--context window|egl|osmesa|null|software] [--loops 1] [--output report.json]
+
+struct ReplayResult {
+  uint32_t frames     = 0;
+  double   mean_ms    = 0.;
+  double   p50_ms     = 0.;
+  double   p95_ms     = 0.;
+  double   p99_ms     = 0.;
+  double   max_ms     = 0.;
+  double   draw_calls = 0.;  // Per frame
+};
+
+static ReplayResult Summarize(std::vector<float> frame_times, uint32_t draw_calls) {
+  std::sort(frame_times.begin(), frame_times.end());
+
+  const auto percentile = [&](double p) {
+    if (frame_times.empty()) return 0.;
+    return (double)frame_times[std::min<size_t>(frame_times.size() - 1, (size_t)(p / 100. * frame_times.size()))];
+  };
+
+  double total = 0.;
+  for (float frame_time : frame_times) total += frame_time;
+
+  const double frames = std::max<size_t>(frame_times.size(), 1);
+
+  return {(uint32_t)frame_times.size(),
+          total * 1000. / frames,
+          percentile(50.) * 1000.,
+          percentile(95.) * 1000.,
+          percentile(99.) * 1000.,
+          (frame_times.empty() ? 0. : frame_times.back()) * 1000.,
+          draw_calls / frames};
+}
+
+class Replay : public Application {
+ public:
+  Replay(const std::string& filepath, uint32_t loops) : pFilepath(filepath), pLoops(loops) {}
+
+  ReplayResult Result() const { return Summarize(pFrameTimes, pDrawCalls); }
+
+ protected:
+  rcode pOnLaunch() override {
+    Renderer::Init();
+    pPlayer.Open(pFilepath);
+
+    return rcode::ok;
+  }
+
+  // et() is the duration of the previous frame, so the first one, which has no predecessor, is skipped
+  rcode pOnUpdate() override {
+    if (pFrame++ > 0) pFrameTimes.push_back(et());
+    return rcode::ok;
+  }
+
+  rcode pOnRender() override {
+    const uint32_t draw_calls = Renderer::GetStats().draw_calls;
+
+    if (!pPlayer.PlayFrame()) {
+      if (++pLoop == pLoops) {
+        Close();
+        return rcode::ok;
+      }
+
+      pPlayer.Rewind();
+      pPlayer.PlayFrame();
+    }
+
+    pDrawCalls += Renderer::GetStats().draw_calls - draw_calls;
+    return rcode::ok;
+  }
+
+  rcode pOnClose() override {
+    pPlayer.Release();
+    Renderer::Delete();
+
+    return rcode::ok;
+  }
+
+ private:
+  std::string   pFilepath;
+  CommandPlayer pPlayer;
+  uint32_t      pLoops     = 1;
+  uint32_t      pLoop      = 0;
+  uint32_t      pFrame     = 0;
+  uint32_t      pDrawCalls = 0;
+
+  std::vector<float> pFrameTimes;
+};
+
+// Without GL there is no application frame loop, so frames are played back to back here
+static ReplayResult ReplayOffscreen(const std::string& filepath, RenderBackend& backend, uint32_t loops) {
+  using clock = std::chrono::steady_clock;
+
+  Renderer::SetBackend(&backend);
+  Renderer::Init();
+
+  CommandPlayer player;
+  player.Open(filepath, false);
+
+  SoftwareBackend* software = dynamic_cast<SoftwareBackend*>(&backend);
+  if (software) software->Resize(player.Size());
+
+  std::vector<float> frame_times;
+  const uint32_t     draw_calls = Renderer::GetStats().draw_calls;
+
+  for (uint32_t loop = 0; loop < loops; loop++) {
+    player.Rewind();
+
+    while (true) {
+      const auto start = clock::now();
+
+      Renderer::NewFrame();
+      if (!player.PlayFrame()) break;
+      if (software) software->Finish();
+
+      frame_times.push_back(std::chrono::duration<float>(clock::now() - start).count());
+    }
+  }
+
+  const ReplayResult result = Summarize(frame_times, Renderer::GetStats().draw_calls - draw_calls);
+
+  player.Release();
+  Renderer::Delete();
+
+  return result;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) Logger::Die("Usage: pixel_replay recording.pxrc [--context name] [--loops 1] [--output report.json]");
+
+  const std::string filepath = argv[1];
+  std::string       context  = "window";
+  std::string       output   = "";
+  uint32_t          loops    = 1;
+
+  for (int i = 2; i < argc; i += 2) {
+    const std::string_view option = argv[i];
+    if (i + 1 == argc) Logger::Die("Missing value for " + std::string(option));
+
+    if (option == "--context") {
+      context = argv[i + 1];
+
+    } else if (option == "--loops") {
+      loops = std::max(std::atoi(argv[i + 1]), 1);
+
+    } else if (option == "--output") {
+      output = argv[i + 1];
+
+    } else {
+      Logger::Die("Unknown option " + std::string(option));
+    }
+  }
+
+  ReplayResult result;
+  std::string  checksum = "";
+
+  if (context == "null") {
+    NullBackend backend;
+    result = ReplayOffscreen(filepath, backend, loops);
+
+    std::ostringstream hex;
+    hex << std::hex << backend.Counters().checksum;
+    checksum = hex.str();
+
+  } else if (context == "software") {
+    SoftwareBackend backend;
+    backend.Create({1, 1});
+
+    result = ReplayOffscreen(filepath, backend, loops);
+
+  } else if (context == "window" || context == "egl" || context == "osmesa") {
+    // Only the header is needed for the window size, the application reopens the file on its graphics thread
+    CommandPlayer header;
+    header.Open(filepath, false);
+
+    Replay replay(filepath, loops);
+    replay.Construct(header.Size(), {0, 0}, "pixel_replay", {0.f, 0.f, 0.f, 1.f}, Antialiasing::none);
+    replay.SetFramePacing({VSync::off});
+    header.Release();
+
+    if (context == "window") {
+      replay.Launch();
+
+    } else {
+      replay.LaunchHeadless(context == "osmesa" ? HeadlessContext::osmesa : HeadlessContext::egl);
+    }
+
+    result = replay.Result();
+
+  } else {
+    Logger::Die("Unknown context " + context);
+  }
+
+  std::ofstream file;
+  if (!output.empty()) {
+    file.open(output);
+    if (!file) Logger::Die("Cannot open " + output);
+  }
+
+  std::ostream& out = output.empty() ? std::cout : file;
+
+  out << "{\"recording\": \"" << filepath << "\", \"context\": \"" << context << "\", \"frames\": " << result.frames
+      << ", \"mean_ms\": " << result.mean_ms << ", \"p50_ms\": " << result.p50_ms << ", \"p95_ms\": " << result.p95_ms
+      << ", \"p99_ms\": " << result.p99_ms << ", \"max_ms\": " << result.max_ms
+      << ", \"draw_calls\": " << result.draw_calls;
+
+  if (!checksum.empty()) out << ", \"checksum\": \"" << checksum << "\"";
+  out << "}\n";
+}